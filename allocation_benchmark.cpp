@@ -0,0 +1,98 @@
+// A separate program: it replaces the global operator new to count every heap allocation,
+// which must not happen in the search server binary and its tests.
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "benchmarks.h"
+#include "search_server.h"
+
+using namespace std::literals;
+
+namespace {
+
+std::atomic<size_t> heap_allocation_count{0};
+
+} // namespace
+
+void* operator new(size_t size) {
+    heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+void BenchmarkQueryAllocations() {
+    constexpr int kDocumentCount = 100'000;
+    constexpr int kQueryCount = 1000;
+
+    const std::vector<std::string> documents = benchmarks::GenerateCorpus(kDocumentCount, 20, 50'000);
+
+    SearchServer search_server("w0"s);
+
+    for (int i = 0; i < kDocumentCount; ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+    }
+
+    const std::string query = "w1 w2 w3 w20 w300 -w4"s;
+
+    for (const Evaluation evaluation : {Evaluation::exhaustive, Evaluation::block_max_wand, Evaluation::max_score}) {
+        SearchOptions options;
+        options.evaluation = evaluation;
+
+        // the first queries size the thread arena and the accumulator and fill the caches
+        size_t found_documents = 0;
+
+        for (int i = 0; i < 10; ++i) {
+            found_documents += search_server.FindTopDocuments(options, query).size();
+        }
+
+        // the result vector is the only allocation a query is expected to make, and only when it is not empty
+        long long result_allocations = 0;
+        const size_t allocations_before = heap_allocation_count.load();
+
+        for (int i = 0; i < kQueryCount; ++i) {
+            const std::vector<Document> result = search_server.FindTopDocuments(options, query);
+
+            found_documents += result.size();
+            result_allocations += result.capacity() > 0 ? 1 : 0;
+        }
+
+        const long long query_allocations = static_cast<long long>(heap_allocation_count.load() - allocations_before) - result_allocations;
+
+        std::cout << "evaluation "s << static_cast<int>(evaluation) << ": "s << query_allocations
+                  << " heap allocations besides results in "s << kQueryCount << " queries, found "s
+                  << found_documents << " documents"s << std::endl;
+    }
+} // BenchmarkQueryAllocations
+
+int main() {
+    BenchmarkQueryAllocations();
+}
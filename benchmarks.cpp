@@ -0,0 +1,839 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <set>
+#include <thread>
+
+#include "benchmarks.h"
+#include "log_duration.h"
+#include "search_server.h"
+#include "string_processing.h"
+#include "stop_word_filter.h"
+#include "term_dictionary.h"
+#include "compressed_posting_list.h"
+#include "posting_intersection.h"
+#include "quantization_report.h"
+#include "sharded_search_server.h"
+#include "concurrent_search_server.h"
+#include "segmented_search_server.h"
+
+using namespace std::literals;
+
+namespace benchmarks {
+
+std::vector<std::string> GenerateCorpus(int document_count, int words_per_document, int vocabulary_size) {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> distribution(0.0, std::log(static_cast<double>(vocabulary_size)));
+
+    std::vector<std::string> documents;
+    documents.reserve(static_cast<size_t>(document_count));
+
+    for (int i = 0; i < document_count; ++i) {
+        std::string document;
+
+        for (int j = 0; j < words_per_document; ++j) {
+            const int word_index = static_cast<int>(std::exp(distribution(generator))) - 1;
+
+            if (j > 0) {
+                document += ' ';
+            }
+
+            document += "w"s + std::to_string(word_index);
+        }
+
+        documents.push_back(std::move(document));
+    }
+
+    return documents;
+} // GenerateCorpus
+
+void BenchmarkCommonTermQueries() {
+    constexpr int kDocumentCount = 100'000;
+    constexpr int kQueryCount = 100;
+
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount, 20, 50'000);
+
+    SearchServer search_server("w0"s);
+
+    {
+        LOG_DURATION_STREAM("Indexing "s + std::to_string(kDocumentCount) + " documents"s, std::cout);
+
+        for (int i = 0; i < kDocumentCount; ++i) {
+            search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+        }
+    }
+
+    std::cout << search_server.GetMemoryReport() << std::endl;
+
+    size_t found_documents = 0;
+
+    {
+        LOG_DURATION_STREAM(std::to_string(kQueryCount) + " common term queries"s, std::cout);
+
+        for (int i = 0; i < kQueryCount; ++i) {
+            found_documents += search_server.FindTopDocuments("w1 w2 w3 -w4"s).size();
+        }
+    }
+
+    std::cout << "found "s << found_documents << " documents"s << std::endl;
+} // BenchmarkCommonTermQueries
+
+void BenchmarkPostingCompression() {
+    constexpr int kPostingCount = 10'000'000;
+    constexpr int kDecodeRounds = 10;
+
+    std::mt19937 generator(42);
+    std::geometric_distribution<int> gap_distribution(0.05);
+    std::uniform_int_distribution<int> word_count_distribution(1, 50);
+
+    PostingList postings;
+    int document_id = 0;
+
+    for (int i = 0; i < kPostingCount; ++i) {
+        document_id += gap_distribution(generator) + 1;
+        postings.Add(document_id, 1.0 / word_count_distribution(generator));
+    }
+
+    const CompressedPostingList compressed_postings(postings);
+
+    std::cout << "plain: "s << static_cast<double>(postings.GetMemoryUsage()) / kPostingCount << " B/posting, "s
+              << "compressed: "s << static_cast<double>(compressed_postings.GetMemoryUsage()) / kPostingCount
+              << " B/posting"s << std::endl;
+
+    int document_ids[CompressedPostingList::kBlockSize];
+    double term_frequencies[CompressedPostingList::kBlockSize];
+    long long checksum = 0;
+
+    const auto start_time = std::chrono::steady_clock::now();
+
+    for (int round = 0; round < kDecodeRounds; ++round) {
+        for (size_t block_index = 0; block_index < compressed_postings.GetBlockCount(); ++block_index) {
+            const size_t block_size = compressed_postings.DecodeBlock(block_index, document_ids, term_frequencies);
+            checksum += document_ids[block_size - 1];
+        }
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+
+    std::cout << "decode: "s << kPostingCount * static_cast<double>(kDecodeRounds) / elapsed.count() / 1e6
+              << " M postings/s (checksum "s << checksum << ")"s << std::endl;
+} // BenchmarkPostingCompression
+
+void BenchmarkCompressedQueries() {
+    constexpr int kDocumentCount = 100'000;
+    constexpr int kQueryCount = 100;
+
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount, 20, 50'000);
+
+    SearchServer search_server("w0"s);
+
+    for (int i = 0; i < kDocumentCount; ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+    }
+
+    search_server.CompressPostings(Policy::parallel);
+
+    std::cout << search_server.GetMemoryReport() << std::endl;
+
+    size_t found_documents = 0;
+
+    {
+        LOG_DURATION_STREAM(std::to_string(kQueryCount) + " common term queries over compressed postings"s, std::cout);
+
+        for (int i = 0; i < kQueryCount; ++i) {
+            found_documents += search_server.FindTopDocuments("w1 w2 w3 -w4"s).size();
+        }
+    }
+
+    std::cout << "found "s << found_documents << " documents"s << std::endl;
+} // BenchmarkCompressedQueries
+
+void BenchmarkDynamicPruning() {
+    constexpr int kDocumentCount = 200'000;
+    constexpr int kQueryCount = 100;
+
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount, 20, 50'000);
+
+    SearchServer search_server;
+
+    for (int i = 0; i < kDocumentCount; ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+    }
+
+    const std::string query = "w1 w5 w20 w300 w4000"s;
+
+    for (const Evaluation evaluation : {Evaluation::exhaustive, Evaluation::block_max_wand, Evaluation::max_score}) {
+        EvaluationStatistics statistics;
+
+        SearchOptions options;
+        options.evaluation = evaluation;
+        options.statistics = &statistics;
+
+        size_t found_documents = 0;
+
+        {
+            LOG_DURATION_STREAM(std::to_string(kQueryCount) + " queries, evaluation "s + std::to_string(static_cast<int>(evaluation)),
+                                std::cout);
+
+            for (int i = 0; i < kQueryCount; ++i) {
+                found_documents += search_server.FindTopDocuments(options, query).size();
+            }
+        }
+
+        std::cout << "found "s << found_documents << " documents, skipped "s << statistics.GetPostingsSkipped()
+                  << " of "s << statistics.postings_total << " postings per query"s << std::endl;
+    }
+} // BenchmarkDynamicPruning
+
+void BenchmarkShardedSearch() {
+    constexpr int kDocumentCount = 200'000;
+    constexpr int kQueryCount = 100;
+
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount, 20, 50'000);
+    const size_t shard_count = std::max(1u, std::thread::hardware_concurrency());
+
+    SearchServer search_server;
+    ShardedSearchServer sharded_search_server(shard_count);
+
+    for (int i = 0; i < kDocumentCount; ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+        sharded_search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+    }
+
+    const std::string query = "w1 w2 w3 w4 w5"s;
+
+    {
+        LOG_DURATION_STREAM(std::to_string(kQueryCount) + " queries on a single server"s, std::cout);
+
+        for (int i = 0; i < kQueryCount; ++i) {
+            search_server.FindTopDocuments(query);
+        }
+    }
+
+    {
+        LOG_DURATION_STREAM(std::to_string(kQueryCount) + " queries on "s + std::to_string(shard_count) + " shards"s, std::cout);
+
+        for (int i = 0; i < kQueryCount; ++i) {
+            sharded_search_server.FindTopDocuments(query);
+        }
+    }
+} // BenchmarkShardedSearch
+
+void BenchmarkMixedReadWrite() {
+    constexpr int kDocumentCount = 50'000;
+    constexpr int kAddedDocumentCount = 5'000;
+    constexpr int kBatchSize = 500;
+    constexpr int kReaderCount = 2;
+
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount + kAddedDocumentCount, 20, 50'000);
+
+    ConcurrentSearchServer search_server;
+
+    search_server.Update([&documents](SearchServer& server) {
+        for (int i = 0; i < kDocumentCount; ++i) {
+            server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+        }
+    });
+
+    std::atomic<bool> is_writing = true;
+    std::vector<std::vector<double>> reader_latencies(kReaderCount);
+    std::vector<std::thread> readers;
+
+    for (int reader_index = 0; reader_index < kReaderCount; ++reader_index) {
+        readers.emplace_back([&search_server, &is_writing, &latencies = reader_latencies[reader_index], reader_index] {
+            const std::string query = "w"s + std::to_string(reader_index + 1) + " w10 w100"s;
+
+            while (is_writing) {
+                const auto start_time = std::chrono::steady_clock::now();
+                search_server.FindTopDocuments(query);
+                const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start_time;
+
+                latencies.push_back(elapsed.count());
+            }
+        });
+    }
+
+    {
+        LOG_DURATION_STREAM("Adding "s + std::to_string(kAddedDocumentCount) + " documents in batches of "s
+                            + std::to_string(kBatchSize) + " under read load"s, std::cout);
+
+        for (int batch_begin = kDocumentCount; batch_begin < kDocumentCount + kAddedDocumentCount; batch_begin += kBatchSize) {
+            search_server.Update([&documents, batch_begin](SearchServer& server) {
+                for (int i = batch_begin; i < batch_begin + kBatchSize; ++i) {
+                    server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+                }
+            });
+        }
+    }
+
+    is_writing = false;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    std::vector<double> latencies;
+    for (const std::vector<double>& reader_latency : reader_latencies) {
+        latencies.insert(latencies.end(), reader_latency.begin(), reader_latency.end());
+    }
+
+    if (latencies.empty()) {
+        return;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << latencies.size() << " queries, p50 = "s << latencies[latencies.size() / 2] << " ms, p99 = "s
+              << latencies[latencies.size() * 99 / 100] << " ms"s << std::endl;
+} // BenchmarkMixedReadWrite
+
+void BenchmarkSingleDocumentWrites() {
+    constexpr int kDocumentCount = 50'000;
+    constexpr int kAddedDocumentCount = 2'000;
+
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount + kAddedDocumentCount, 20, 50'000);
+
+    ConcurrentSearchServer search_server;
+
+    search_server.Update([&documents](SearchServer& server) {
+        for (int i = 0; i < kDocumentCount; ++i) {
+            server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+        }
+    });
+
+    {
+        LOG_DURATION_STREAM("Adding "s + std::to_string(kAddedDocumentCount) + " documents one by one"s, std::cout);
+
+        for (int i = kDocumentCount; i < kDocumentCount + kAddedDocumentCount; ++i) {
+            search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+        }
+    }
+
+    std::cout << search_server.GetDocumentCount() << " documents"s << std::endl;
+} // BenchmarkSingleDocumentWrites
+
+void BenchmarkSegmentedIngest() {
+    constexpr int kDocumentCount = 200'000;
+    constexpr int kQueryCount = 100;
+
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount, 20, 50'000);
+
+    SearchServer search_server;
+    SegmentedSearchServer segmented_search_server;
+
+    {
+        LOG_DURATION_STREAM("Adding "s + std::to_string(kDocumentCount) + " documents to a single server"s, std::cout);
+
+        for (int i = 0; i < kDocumentCount; ++i) {
+            search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+        }
+    }
+
+    {
+        LOG_DURATION_STREAM("Adding "s + std::to_string(kDocumentCount) + " documents to a segmented server"s, std::cout);
+
+        for (int i = 0; i < kDocumentCount; ++i) {
+            segmented_search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+        }
+    }
+
+    {
+        LOG_DURATION_STREAM("Waiting for segment merges"s, std::cout);
+
+        segmented_search_server.WaitForMerges();
+    }
+
+    std::cout << segmented_search_server.GetSegmentCount() << " segments"s << std::endl;
+
+    const std::string query = "w1 w20 w300"s;
+
+    {
+        LOG_DURATION_STREAM(std::to_string(kQueryCount) + " queries on a single server"s, std::cout);
+
+        for (int i = 0; i < kQueryCount; ++i) {
+            search_server.FindTopDocuments(query);
+        }
+    }
+
+    {
+        LOG_DURATION_STREAM(std::to_string(kQueryCount) + " queries on a segmented server"s, std::cout);
+
+        for (int i = 0; i < kQueryCount; ++i) {
+            segmented_search_server.FindTopDocuments(query);
+        }
+    }
+} // BenchmarkSegmentedIngest
+
+void BenchmarkRemoveDocuments() {
+    constexpr int kDocumentCount = 5'000;
+    constexpr int kRemovedDocumentCount = 1'000;
+
+    // long documents with many unique words each
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount, 2'000, 50'000);
+
+    SearchServer search_server;
+
+    for (int i = 0; i < kDocumentCount; ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+    }
+
+    // keeps every tombstone until the explicit compaction below
+    search_server.SetMaxDeletedRatio(1.0);
+
+    {
+        LOG_DURATION_STREAM("Removing "s + std::to_string(kRemovedDocumentCount) + " documents"s, std::cout);
+
+        for (int i = 0; i < kRemovedDocumentCount; ++i) {
+            search_server.RemoveDocument(i * (kDocumentCount / kRemovedDocumentCount));
+        }
+    }
+
+    {
+        LOG_DURATION_STREAM("Compacting postings"s, std::cout);
+
+        search_server.CompactPostings(Policy::parallel);
+    }
+} // BenchmarkRemoveDocuments
+
+void BenchmarkBulkIngest() {
+    constexpr int kDocumentCount = 200'000;
+
+    const std::vector<std::string> texts = GenerateCorpus(kDocumentCount, 20, 50'000);
+
+    std::vector<NewDocument> documents;
+    documents.reserve(kDocumentCount);
+
+    for (int i = 0; i < kDocumentCount; ++i) {
+        documents.push_back({i, texts[i], DocumentStatus::ACTUAL, {i % 10}});
+    }
+
+    {
+        SearchServer search_server;
+
+        LOG_DURATION_STREAM("Adding "s + std::to_string(kDocumentCount) + " documents one by one"s, std::cout);
+
+        for (const NewDocument& document : documents) {
+            search_server.AddDocument(document.id, document.text, document.status, document.ratings);
+        }
+    }
+
+    for (const Policy policy : {Policy::sequential, Policy::parallel}) {
+        SearchServer search_server;
+
+        LOG_DURATION_STREAM("Adding "s + std::to_string(kDocumentCount) + " documents in a "s
+                            + (policy == Policy::parallel ? "parallel"s : "sequential"s) + " batch"s, std::cout);
+
+        search_server.AddDocuments(documents, policy);
+    }
+} // BenchmarkBulkIngest
+
+void BenchmarkInverseDocumentFrequencyCache() {
+    constexpr int kDocumentCount = 2'000;
+    constexpr int kQueryCount = 20'000;
+
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount, 20, 50'000);
+
+    SearchServer search_server;
+
+    for (int i = 0; i < kDocumentCount; ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+    }
+
+    // many rare words, so inverse document frequencies are a large share of the work
+    std::string query;
+    for (int word = 1'000; word < 1'020; ++word) {
+        query += "w"s + std::to_string(word) + " "s;
+    }
+
+    const CollectionStatistics collection_statistics = search_server.GetCollectionStatistics(query);
+
+    SearchOptions uncached_options;
+    uncached_options.collection_statistics = &collection_statistics;
+
+    {
+        LOG_DURATION_STREAM(std::to_string(kQueryCount) + " queries computing frequencies from statistics"s, std::cout);
+
+        for (int i = 0; i < kQueryCount; ++i) {
+            search_server.FindTopDocuments(uncached_options, query);
+        }
+    }
+
+    {
+        LOG_DURATION_STREAM(std::to_string(kQueryCount) + " queries with cached frequencies"s, std::cout);
+
+        for (int i = 0; i < kQueryCount; ++i) {
+            search_server.FindTopDocuments(query);
+        }
+    }
+} // BenchmarkInverseDocumentFrequencyCache
+
+void BenchmarkQuantization() {
+    constexpr int kDocumentCount = 100'000;
+    constexpr int kQueryCount = 500;
+
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount, 20, 50'000);
+
+    SearchServer search_server;
+
+    for (int i = 0; i < kDocumentCount; ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+    }
+
+    // a frequent, a medium and a rare word in every query
+    std::vector<std::string> queries;
+    for (int i = 0; i < kQueryCount; ++i) {
+        queries.push_back("w"s + std::to_string(i % 10) + " w"s + std::to_string(100 + i) + " w"s + std::to_string(5'000 + i));
+    }
+
+    for (const Quantization quantization : {Quantization::uint16, Quantization::uint8}) {
+        const std::string name = quantization == Quantization::uint8 ? "8 bit"s : "16 bit"s;
+
+        SearchServer quantized_search_server = search_server;
+        quantized_search_server.CompressPostings(Policy::parallel, quantization);
+
+        std::cout << name << ": "s << static_cast<double>(quantized_search_server.GetMemoryReport().compressed_posting_bytes)
+                  / static_cast<double>(quantized_search_server.GetMemoryReport().posting_count) << " B/posting, "s
+                  << MeasureQuantization(search_server, queries, quantization) << std::endl;
+
+        LOG_DURATION_STREAM(std::to_string(kQueryCount) + " queries on "s + name + " term frequencies"s, std::cout);
+
+        for (const std::string& query : queries) {
+            quantized_search_server.FindTopDocuments(query);
+        }
+    }
+} // BenchmarkQuantization
+
+void BenchmarkForwardIndex() {
+    constexpr int kDocumentCount = 100'000;
+
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount, 20, 50'000);
+
+    SearchServer search_server;
+
+    for (int i = 0; i < kDocumentCount; ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+    }
+
+    const MemoryReport report = search_server.GetMemoryReport();
+
+    // a red-black tree node is a color, three pointers and the value, before allocator overhead
+    const size_t map_node_bytes = 4 * sizeof(void*) + sizeof(std::pair<const TermId, double>);
+
+    std::cout << "forward index: "s << static_cast<double>(report.forward_index_bytes) / static_cast<double>(report.posting_count)
+              << " B/term, map nodes: "s << map_node_bytes << " B/term"s << std::endl;
+
+    double checksum = 0.0;
+
+    {
+        LOG_DURATION_STREAM("Reading word frequencies of "s + std::to_string(kDocumentCount) + " documents"s, std::cout);
+
+        for (const int document_id : search_server) {
+            for (const auto& [word, term_frequency] : search_server.GetWordFrequencies(document_id)) {
+                checksum += static_cast<double>(word.size()) * term_frequency;
+            }
+        }
+    }
+
+    std::cout << "checksum "s << checksum << std::endl;
+} // BenchmarkForwardIndex
+
+void BenchmarkMinusWords() {
+    constexpr int kDocumentCount = 200'000;
+    constexpr int kQueryCount = 100;
+
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount, 20, 50'000);
+
+    SearchServer search_server;
+
+    for (int i = 0; i < kDocumentCount; ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+    }
+
+    // the minus words are among the most frequent ones, their bitmaps get cached after a few queries
+    const std::string query = "w10 w20 w30 -w0 -w1"s;
+
+    size_t found_documents = 0;
+
+    {
+        LOG_DURATION_STREAM(std::to_string(kQueryCount) + " queries with frequent minus words"s, std::cout);
+
+        for (int i = 0; i < kQueryCount; ++i) {
+            found_documents += search_server.FindTopDocuments(query).size();
+        }
+    }
+
+    std::cout << "found "s << found_documents << " documents, "s << search_server.GetMemoryReport().exclusion_bitmap_bytes
+              << " B of exclusion bitmaps"s << std::endl;
+} // BenchmarkMinusWords
+
+void BenchmarkConjunctiveQueries() {
+    constexpr int kDocumentCount = 200'000;
+    constexpr int kQueryCount = 100;
+
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount, 20, 50'000);
+
+    SearchServer search_server;
+
+    for (int i = 0; i < kDocumentCount; ++i) {
+        search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {i % 10});
+    }
+
+    const std::string query = "w1 w2 w5"s;
+
+    for (const Matching matching : {Matching::any, Matching::all}) {
+        SearchOptions options;
+        options.matching = matching;
+
+        size_t found_documents = 0;
+
+        {
+            LOG_DURATION_STREAM(std::to_string(kQueryCount) + " queries, matching "s + std::to_string(static_cast<int>(matching)),
+                                std::cout);
+
+            for (int i = 0; i < kQueryCount; ++i) {
+                found_documents += search_server.FindTopDocuments(options, query).size();
+            }
+        }
+
+        std::cout << "found "s << found_documents << " documents"s << std::endl;
+    }
+
+    // every third and every fifth id, so a fifteenth of them are common
+    std::vector<int> left;
+    std::vector<int> right;
+
+    for (int id = 0; id < 3'000'000; ++id) {
+        if (id % 3 == 0) {
+            left.push_back(id);
+        }
+        if (id % 5 == 0) {
+            right.push_back(id);
+        }
+    }
+
+    std::vector<int> output(left.size());
+
+    for (const IntersectionKernel kernel : {IntersectionKernel::scalar, IntersectionKernel::galloping,
+                                            IntersectionKernel::sse, IntersectionKernel::avx2}) {
+        if (!IsSupported(kernel)) {
+            continue;
+        }
+
+        size_t common_count = 0;
+
+        {
+            LOG_DURATION_STREAM("Intersection kernel "s + std::to_string(static_cast<int>(kernel)), std::cout);
+
+            for (int i = 0; i < 10; ++i) {
+                common_count += IntersectDocumentIds(kernel, left.data(), left.size(), right.data(), right.size(), output.data());
+            }
+        }
+
+        std::cout << common_count << " common ids"s << std::endl;
+    }
+} // BenchmarkConjunctiveQueries
+
+void BenchmarkTokenization() {
+    constexpr int kDocumentCount = 200'000;
+
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount, 20, 50'000);
+
+    size_t word_count = 0;
+
+    {
+        LOG_DURATION_STREAM("Stream tokenization of "s + std::to_string(kDocumentCount) + " documents"s, std::cout);
+
+        for (const std::string& document : documents) {
+            // the validation pass the single scan replaces
+            if (std::none_of(document.begin(), document.end(), [](char c) { return c >= '\0' && c < ' '; })) {
+                word_count += string_processing::SplitIntoWords(document).size();
+            }
+        }
+    }
+
+    std::vector<std::string_view> words;
+
+    {
+        LOG_DURATION_STREAM("Single scan tokenization of "s + std::to_string(kDocumentCount) + " documents"s, std::cout);
+
+        for (const std::string& document : documents) {
+            if (string_processing::SplitIntoValidWords(document, words)) {
+                word_count -= words.size();
+            }
+        }
+    }
+
+    std::cout << "word count difference "s << word_count << std::endl;
+} // BenchmarkTokenization
+
+void BenchmarkStopWords() {
+    constexpr int kDocumentCount = 200'000;
+
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount, 20, 50'000);
+
+    std::set<std::string, std::less<>> stop_word_set;
+    StopWordFilter stop_word_filter;
+
+    for (int i = 0; i < 300; i += 10) {
+        stop_word_set.insert("w"s + std::to_string(i));
+        stop_word_filter.Insert("w"s + std::to_string(i));
+    }
+
+    std::vector<std::string_view> words;
+    for (const std::string& document : documents) {
+        const std::vector<std::string_view> document_words = string_processing::SplitIntoWords(std::string_view(document));
+        words.insert(words.end(), document_words.begin(), document_words.end());
+    }
+
+    size_t stop_word_count = 0;
+
+    {
+        LOG_DURATION_STREAM("Set lookups of "s + std::to_string(words.size()) + " words"s, std::cout);
+
+        for (const std::string_view word : words) {
+            stop_word_count += stop_word_set.count(word);
+        }
+    }
+
+    {
+        LOG_DURATION_STREAM("Filter lookups of "s + std::to_string(words.size()) + " words"s, std::cout);
+
+        for (const std::string_view word : words) {
+            stop_word_count -= stop_word_filter.Contains(word) ? 1 : 0;
+        }
+    }
+
+    std::cout << "stop word count difference "s << stop_word_count << std::endl;
+} // BenchmarkStopWords
+
+void BenchmarkTermLookup() {
+    constexpr int kTermCount = 1'000'000;
+
+    std::vector<std::string> words;
+    words.reserve(kTermCount);
+
+    for (int i = 0; i < kTermCount; ++i) {
+        words.push_back("term"s + std::to_string(static_cast<long long>(i) * 7919 % kTermCount));
+    }
+
+    TermDictionary terms;
+
+    {
+        LOG_DURATION_STREAM("Interning "s + std::to_string(kTermCount) + " terms"s, std::cout);
+
+        for (const std::string& word : words) {
+            terms.Intern(word);
+        }
+    }
+
+    size_t found_count = 0;
+
+    {
+        LOG_DURATION_STREAM("Looking up "s + std::to_string(kTermCount) + " terms"s, std::cout);
+
+        for (const std::string& word : words) {
+            found_count += terms.Find(word).has_value() ? 1 : 0;
+        }
+    }
+
+    std::cout << "found "s << found_count << " terms, "s << terms.GetMemoryUsage() << " B"s << std::endl;
+} // BenchmarkTermLookup
+
+void BenchmarkPredicateFiltering() {
+    constexpr int kDocumentCount = 200'000;
+    constexpr int kQueryCount = 100;
+
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount, 20, 50'000);
+
+    SearchServer search_server;
+
+    for (int i = 0; i < kDocumentCount; ++i) {
+        search_server.AddDocument(i, documents[i], i % 4 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL, {i % 10});
+    }
+
+    // frequent words, so every query filters tens of thousands of candidates
+    const std::string query = "w0 w1 w2"s;
+    const auto predicate = [](int document_id, DocumentStatus status, int rating) {
+        return status == DocumentStatus::ACTUAL && rating > 4 && document_id % 3 != 0;
+    };
+
+    size_t found_documents = 0;
+
+    {
+        LOG_DURATION_STREAM(std::to_string(kQueryCount) + " queries filtered by a predicate"s, std::cout);
+
+        for (int i = 0; i < kQueryCount; ++i) {
+            found_documents += search_server.FindTopDocuments(query, predicate).size();
+        }
+    }
+
+    std::cout << "found "s << found_documents << " documents, "s << search_server.GetMemoryReport().document_column_bytes
+              << " B of document columns"s << std::endl;
+} // BenchmarkPredicateFiltering
+
+void BenchmarkStatusFiltering() {
+    constexpr int kDocumentCount = 200'000;
+    constexpr int kQueryCount = 100;
+
+    const std::vector<std::string> documents = GenerateCorpus(kDocumentCount, 20, 50'000);
+
+    SearchServer search_server;
+
+    // most of the collection is not actual, as in an archive
+    for (int i = 0; i < kDocumentCount; ++i) {
+        search_server.AddDocument(i, documents[i], i % 5 == 0 ? DocumentStatus::ACTUAL : DocumentStatus::REMOVED, {i % 10});
+    }
+
+    const std::string query = "w0 w1 w2"s;
+    const auto predicate = [](int , DocumentStatus status, int ) {
+        return status == DocumentStatus::ACTUAL;
+    };
+
+    size_t predicate_documents = 0;
+    size_t status_documents = 0;
+
+    {
+        LOG_DURATION_STREAM(std::to_string(kQueryCount) + " queries, status checked by a predicate"s, std::cout);
+
+        for (int i = 0; i < kQueryCount; ++i) {
+            predicate_documents += search_server.FindTopDocuments(query, predicate).size();
+        }
+    }
+
+    {
+        LOG_DURATION_STREAM(std::to_string(kQueryCount) + " queries, status bitmap"s, std::cout);
+
+        for (int i = 0; i < kQueryCount; ++i) {
+            status_documents += search_server.FindTopDocuments(query, DocumentStatus::ACTUAL).size();
+        }
+    }
+
+    std::cout << "found "s << predicate_documents << " and "s << status_documents << " documents"s << std::endl;
+} // BenchmarkStatusFiltering
+
+void RunBenchmarks() {
+    BenchmarkCommonTermQueries();
+    BenchmarkPostingCompression();
+    BenchmarkCompressedQueries();
+    BenchmarkDynamicPruning();
+    BenchmarkShardedSearch();
+    BenchmarkMixedReadWrite();
+    BenchmarkSingleDocumentWrites();
+    BenchmarkSegmentedIngest();
+    BenchmarkRemoveDocuments();
+    BenchmarkBulkIngest();
+    BenchmarkInverseDocumentFrequencyCache();
+    BenchmarkQuantization();
+    BenchmarkForwardIndex();
+    BenchmarkMinusWords();
+    BenchmarkConjunctiveQueries();
+    BenchmarkTokenization();
+    BenchmarkStopWords();
+    BenchmarkTermLookup();
+    BenchmarkPredicateFiltering();
+    BenchmarkStatusFiltering();
+}
+
+} // namespace benchmarks
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace benchmarks {
+
+// deterministic corpus whose word frequencies roughly follow Zipf's law
+std::vector<std::string> GenerateCorpus(int document_count, int words_per_document, int vocabulary_size);
+
+void BenchmarkCommonTermQueries();
+
+void BenchmarkPostingCompression();
+
+void BenchmarkCompressedQueries();
+
+void BenchmarkDynamicPruning();
+
+void BenchmarkShardedSearch();
+
+void BenchmarkMixedReadWrite();
+
+void BenchmarkSingleDocumentWrites();
+
+void BenchmarkSegmentedIngest();
+
+void BenchmarkRemoveDocuments();
+
+void BenchmarkBulkIngest();
+
+void BenchmarkInverseDocumentFrequencyCache();
+
+void BenchmarkQuantization();
+
+void BenchmarkForwardIndex();
+
+void BenchmarkMinusWords();
+
+void BenchmarkConjunctiveQueries();
+
+void BenchmarkTokenization();
+
+void BenchmarkStopWords();
+
+void BenchmarkTermLookup();
+
+void BenchmarkPredicateFiltering();
+
+void BenchmarkStatusFiltering();
+
+void RunBenchmarks();
+
+} // namespace benchmarks
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "compressed_posting_list.h"
+
+namespace {
+
+double GetQuantizationLevels(Quantization quantization) {
+    return quantization == Quantization::uint8 ? 255.0 : 65535.0;
+}
+
+std::uint8_t CountBits(std::uint32_t value) {
+    std::uint8_t bits = 0;
+
+    while (value > 0) {
+        ++bits;
+        value >>= 1;
+    }
+
+    return bits;
+}
+
+} // namespace
+
+CompressedPostingList::CompressedPostingList(const PostingList& postings, Quantization quantization)
+    : quantization_(quantization), size_(postings.size()) {
+    const std::vector<int>& document_ids = postings.GetDocumentIds();
+    const std::vector<double>& term_frequencies = postings.GetTermFrequencies();
+
+    blocks_.reserve((size_ + kBlockSize - 1) / kBlockSize);
+    const double quantization_levels = GetQuantizationLevels(quantization_);
+    quantized_term_frequency_bytes_.reserve(quantization_ == Quantization::uint8 ? size_ : size_ * 2);
+
+    int previous_document_id = -1;
+
+    for (size_t block_begin = 0; block_begin < size_; block_begin += kBlockSize) {
+        const size_t block_end = std::min(block_begin + kBlockSize, size_);
+
+        BlockHeader header;
+        header.last_document_id = document_ids[block_end - 1];
+        header.word_offset = static_cast<std::uint32_t>(packed_document_ids_.size());
+        header.size = static_cast<std::uint16_t>(block_end - block_begin);
+
+        std::uint32_t deltas[kBlockSize];
+        std::uint32_t max_delta = 0;
+
+        for (size_t i = block_begin; i < block_end; ++i) {
+            deltas[i - block_begin] = static_cast<std::uint32_t>(document_ids[i] - previous_document_id - 1);
+            max_delta = std::max(max_delta, deltas[i - block_begin]);
+            previous_document_id = document_ids[i];
+
+            header.max_term_frequency = std::max(header.max_term_frequency, term_frequencies[i]);
+        }
+
+        header.bit_width = CountBits(max_delta);
+
+        const size_t word_count = (header.size * header.bit_width + 31) / 32;
+        packed_document_ids_.resize(packed_document_ids_.size() + word_count, 0);
+        std::uint32_t* words = packed_document_ids_.data() + header.word_offset;
+
+        for (size_t i = 0; i < header.size && header.bit_width > 0; ++i) {
+            const size_t bit_position = i * header.bit_width;
+            const size_t shift = bit_position % 32;
+            const std::uint64_t value = static_cast<std::uint64_t>(deltas[i]) << shift;
+
+            words[bit_position / 32] |= static_cast<std::uint32_t>(value);
+
+            if (shift + header.bit_width > 32) {
+                words[bit_position / 32 + 1] |= static_cast<std::uint32_t>(value >> 32);
+            }
+        }
+
+        for (size_t i = block_begin; i < block_end; ++i) {
+            const double ratio = header.max_term_frequency > 0.0 ? term_frequencies[i] / header.max_term_frequency : 0.0;
+
+            const long quantized = std::lround(ratio * quantization_levels);
+
+            quantized_term_frequency_bytes_.push_back(static_cast<std::uint8_t>(quantized & 0xFF));
+
+            if (quantization_ == Quantization::uint16) {
+                quantized_term_frequency_bytes_.push_back(static_cast<std::uint8_t>(quantized >> 8));
+            }
+        }
+
+        max_term_frequency_ = std::max(max_term_frequency_, header.max_term_frequency);
+        blocks_.push_back(header);
+    }
+} // CompressedPostingList
+
+size_t CompressedPostingList::DecodeBlock(size_t block_index, int* document_ids, double* term_frequencies) const {
+    assert(block_index < blocks_.size());
+
+    const BlockHeader& header = blocks_[block_index];
+    const std::uint32_t* words = packed_document_ids_.data() + header.word_offset;
+    const size_t word_count = (header.size * header.bit_width + 31) / 32;
+    const std::uint64_t mask = (std::uint64_t{1} << header.bit_width) - 1;
+
+    int document_id = block_index == 0 ? -1 : blocks_[block_index - 1].last_document_id;
+
+    for (size_t i = 0; i < header.size; ++i) {
+        std::uint32_t delta = 0;
+
+        if (header.bit_width > 0) {
+            const size_t bit_position = i * header.bit_width;
+            const size_t word_index = bit_position / 32;
+
+            std::uint64_t bits = words[word_index];
+            if (word_index + 1 < word_count) {
+                bits |= static_cast<std::uint64_t>(words[word_index + 1]) << 32;
+            }
+
+            delta = static_cast<std::uint32_t>((bits >> (bit_position % 32)) & mask);
+        }
+
+        document_id += static_cast<int>(delta) + 1;
+        document_ids[i] = document_id;
+    }
+
+    const double scale = header.max_term_frequency / GetQuantizationLevels(quantization_);
+
+    if (quantization_ == Quantization::uint8) {
+        const std::uint8_t* quantized = quantized_term_frequency_bytes_.data() + block_index * kBlockSize;
+
+        for (size_t i = 0; i < header.size; ++i) {
+            term_frequencies[i] = quantized[i] * scale;
+        }
+    } else {
+        const std::uint8_t* quantized = quantized_term_frequency_bytes_.data() + block_index * kBlockSize * 2;
+
+        for (size_t i = 0; i < header.size; ++i) {
+            term_frequencies[i] = (quantized[2 * i] | (quantized[2 * i + 1] << 8)) * scale;
+        }
+    }
+
+    return header.size;
+} // DecodeBlock
+
+PostingList CompressedPostingList::Decode() const {
+    PostingList postings;
+
+    int document_ids[kBlockSize];
+    double term_frequencies[kBlockSize];
+
+    for (size_t block_index = 0; block_index < blocks_.size(); ++block_index) {
+        const size_t block_size = DecodeBlock(block_index, document_ids, term_frequencies);
+
+        for (size_t i = 0; i < block_size; ++i) {
+            postings.Add(document_ids[i], term_frequencies[i]);
+        }
+    }
+
+    return postings;
+} // Decode
+
+size_t CompressedPostingList::GetBlockCount() const {
+    return blocks_.size();
+}
+
+const CompressedPostingList::BlockHeader& CompressedPostingList::GetBlockHeader(size_t block_index) const {
+    return blocks_[block_index];
+}
+
+double CompressedPostingList::GetMaxTermFrequency() const {
+    return max_term_frequency_;
+}
+
+Quantization CompressedPostingList::GetQuantization() const {
+    return quantization_;
+}
+
+size_t CompressedPostingList::size() const {
+    return size_;
+}
+
+bool CompressedPostingList::empty() const {
+    return size_ == 0;
+}
+
+size_t CompressedPostingList::GetMemoryUsage() const {
+    return blocks_.capacity() * sizeof(BlockHeader)
+        + packed_document_ids_.capacity() * sizeof(std::uint32_t)
+        + quantized_term_frequency_bytes_.capacity();
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "posting_list.h"
+
+// bits per stored term frequency, fewer bits trade ranking accuracy for memory
+enum class Quantization {
+    uint8, uint16
+};
+
+// Read-only posting list split into blocks of kBlockSize postings. Document ids
+// are delta encoded and bit packed with a per-block width, term frequencies are
+// quantized to 8 or 16 bits relative to the exactly stored block maximum.
+class CompressedPostingList {
+public:
+    static constexpr size_t kBlockSize = PostingList::kBlockSize;
+
+    struct BlockHeader {
+        int last_document_id = 0;
+        std::uint32_t word_offset = 0;
+        std::uint16_t size = 0;
+        std::uint8_t bit_width = 0;
+        double max_term_frequency = 0.0;
+    };
+
+public:
+    CompressedPostingList() = default;
+
+    explicit CompressedPostingList(const PostingList& postings, Quantization quantization = Quantization::uint16);
+
+public:
+    // fills up to kBlockSize entries and returns how many were decoded
+    size_t DecodeBlock(size_t block_index, int* document_ids, double* term_frequencies) const;
+
+    PostingList Decode() const;
+
+    size_t GetBlockCount() const;
+
+    const BlockHeader& GetBlockHeader(size_t block_index) const;
+
+    // the largest block maximum, found while encoding
+    double GetMaxTermFrequency() const;
+
+    Quantization GetQuantization() const;
+
+    size_t size() const;
+
+    bool empty() const;
+
+    size_t GetMemoryUsage() const;
+
+private:
+    std::vector<BlockHeader> blocks_;
+    std::vector<std::uint32_t> packed_document_ids_;
+    Quantization quantization_ = Quantization::uint16;
+
+    // one or two bytes per posting
+    std::vector<std::uint8_t> quantized_term_frequency_bytes_;
+    size_t size_ = 0;
+    double max_term_frequency_ = 0.0;
+};
@@ -0,0 +1,79 @@
+#include <atomic>
+
+#include "concurrent_search_server.h"
+
+ConcurrentSearchServer::ConcurrentSearchServer(SearchServer search_server)
+    : current_(std::make_shared<SearchServer>(std::move(search_server))) {
+    snapshot_ = current_;
+}
+
+std::shared_ptr<const SearchServer> ConcurrentSearchServer::GetSnapshot() const {
+    return std::atomic_load_explicit(&snapshot_, std::memory_order_acquire);
+}
+
+std::vector<Document> ConcurrentSearchServer::FindTopDocuments(const SearchOptions& options, const std::string& raw_query,
+                                                               const DocumentStatus& desired_status) const {
+    return GetSnapshot()->FindTopDocuments(options, raw_query, desired_status);
+}
+
+std::vector<Document> ConcurrentSearchServer::FindTopDocuments(const std::string& raw_query,
+                                                               const DocumentStatus& desired_status) const {
+    return GetSnapshot()->FindTopDocuments(raw_query, desired_status);
+}
+
+std::tuple<std::vector<std::string>, DocumentStatus> ConcurrentSearchServer::MatchDocument(const std::string& raw_query,
+                                                                                           int document_id) const {
+    return GetSnapshot()->MatchDocument(raw_query, document_id);
+}
+
+int ConcurrentSearchServer::GetDocumentCount() const {
+    return GetSnapshot()->GetDocumentCount();
+}
+
+bool ConcurrentSearchServer::AddDocument(int document_id, const std::string& document,
+                                         DocumentStatus status, const std::vector<int>& ratings) {
+    Write([document_id, document, status, ratings](SearchServer& search_server) {
+        search_server.AddDocument(document_id, document, status, ratings);
+    });
+
+    return true;
+}
+
+void ConcurrentSearchServer::RemoveDocument(int document_id) {
+    Write([document_id](SearchServer& search_server) {
+        search_server.RemoveDocument(document_id);
+    });
+}
+
+void ConcurrentSearchServer::Write(std::function<void(SearchServer&)> write) {
+    std::lock_guard guard(update_mutex_);
+
+    std::shared_ptr<SearchServer> search_server = std::move(standby_);
+
+    // nobody can load the standby anymore, so once the last reader lets it go it is ours
+    if (search_server && search_server.use_count() == 1) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        for (const auto& standby_write : standby_writes_) {
+            standby_write(*search_server);
+        }
+    } else {
+        search_server = std::make_shared<SearchServer>(*current_);
+    }
+
+    standby_writes_.clear();
+
+    // a failed write may leave the server half changed, it is dropped and the standby copied next time
+    write(*search_server);
+
+    Publish(std::move(search_server));
+    standby_writes_.push_back(std::move(write));
+} // Write
+
+void ConcurrentSearchServer::Publish(std::shared_ptr<SearchServer> search_server) {
+    standby_ = std::move(current_);
+    current_ = std::move(search_server);
+
+    // readers holding the previous snapshot keep it alive until they are done
+    std::atomic_store_explicit(&snapshot_, std::shared_ptr<const SearchServer>(current_), std::memory_order_release);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "search_server.h"
+
+// Readers work on an immutable SearchServer snapshot and never wait for writers.
+// A writer applies its changes to a private server and publishes it with a single
+// pointer swap. Update copies the current snapshot, so group many changes in one
+// call to pay for the copy once. Single-document writes keep two servers instead:
+// the write goes to the previous snapshot once readers are done with it, after the
+// writes it missed are repeated there, so a write costs two applications rather
+// than a copy of the index.
+class ConcurrentSearchServer {
+public:
+    explicit ConcurrentSearchServer(SearchServer search_server = SearchServer());
+
+public:
+    // iterate over documents or run several reads against one consistent state through a snapshot
+    std::shared_ptr<const SearchServer> GetSnapshot() const;
+
+    template<typename Predicate>
+    std::vector<Document> FindTopDocuments(const SearchOptions& options, const std::string& raw_query, Predicate predicate) const;
+
+    std::vector<Document> FindTopDocuments(const SearchOptions& options, const std::string& raw_query,
+                                           const DocumentStatus& desired_status = DocumentStatus::ACTUAL) const;
+
+    std::vector<Document> FindTopDocuments(const std::string& raw_query,
+                                           const DocumentStatus& desired_status = DocumentStatus::ACTUAL) const;
+
+    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(const std::string& raw_query, int document_id) const;
+
+    int GetDocumentCount() const;
+
+    // function(SearchServer&) is applied to a copy, nothing is published if it throws
+    template<typename Function>
+    void Update(Function function);
+
+    bool AddDocument(int document_id, const std::string& document,
+                     DocumentStatus status, const std::vector<int>& ratings);
+
+    void RemoveDocument(int document_id);
+
+private:
+    // Applies a write that may be repeated on the standby server, so it must own everything it uses.
+    // The standby is copied from the current server instead when readers still hold it.
+    void Write(std::function<void(SearchServer&)> write);
+
+    // under update_mutex_
+    void Publish(std::shared_ptr<SearchServer> search_server);
+
+private:
+    std::shared_ptr<const SearchServer> snapshot_;
+
+    // guarded by update_mutex_: the published server, and the previous one, which is behind it
+    // by standby_writes_ or null when those are unknown
+    std::shared_ptr<SearchServer> current_;
+    std::shared_ptr<SearchServer> standby_;
+    std::vector<std::function<void(SearchServer&)>> standby_writes_;
+
+    // serializes writers only
+    std::mutex update_mutex_;
+};
+
+template<typename Predicate>
+std::vector<Document> ConcurrentSearchServer::FindTopDocuments(const SearchOptions& options, const std::string& raw_query,
+                                                               Predicate predicate) const {
+    return GetSnapshot()->FindTopDocuments(options, raw_query, predicate);
+}
+
+template<typename Function>
+void ConcurrentSearchServer::Update(Function function) {
+    std::lock_guard guard(update_mutex_);
+
+    auto search_server = std::make_shared<SearchServer>(*current_);
+
+    function(*search_server);
+
+    // the function cannot be repeated on the standby server
+    Publish(std::move(search_server));
+    standby_.reset();
+    standby_writes_.clear();
+} // Update
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <iostream>
 
 struct Document {
@@ -18,6 +19,8 @@ enum class DocumentStatus {
     REMOVED,
 };
 
+constexpr size_t kDocumentStatusCount = 4;
+
 std::ostream& operator<<(std::ostream& out, const DocumentStatus status);
 
 void PrintDocument(const Document& document);
@@ -0,0 +1,47 @@
+#include <algorithm>
+
+#include "document_bitmap.h"
+
+void DocumentBitmap::Resize(size_t document_count) {
+    if (document_count > size_) {
+        size_ = document_count;
+        words_.resize((size_ + kWordBits - 1) / kWordBits, 0);
+    }
+}
+
+void DocumentBitmap::Set(int document_index) {
+    const std::uint64_t mask = std::uint64_t{1} << (static_cast<size_t>(document_index) % kWordBits);
+    std::uint64_t& word = words_[static_cast<size_t>(document_index) / kWordBits];
+
+    if ((word & mask) == 0) {
+        word |= mask;
+        ++count_;
+    }
+} // Set
+
+void DocumentBitmap::Reset(int document_index) {
+    const std::uint64_t mask = std::uint64_t{1} << (static_cast<size_t>(document_index) % kWordBits);
+    std::uint64_t& word = words_[static_cast<size_t>(document_index) / kWordBits];
+
+    if ((word & mask) != 0) {
+        word &= ~mask;
+        --count_;
+    }
+} // Reset
+
+void DocumentBitmap::Clear() {
+    std::fill(words_.begin(), words_.end(), 0);
+    count_ = 0;
+}
+
+size_t DocumentBitmap::Count() const {
+    return count_;
+}
+
+size_t DocumentBitmap::size() const {
+    return size_;
+}
+
+size_t DocumentBitmap::GetMemoryUsage() const {
+    return words_.capacity() * sizeof(std::uint64_t);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One bit per dense document index, used to mark removed documents until their postings are purged,
+// documents excluded by a minus word and documents of each status.
+class DocumentBitmap {
+public:
+    // grows to cover document_count indexes, new bits are clear
+    void Resize(size_t document_count);
+
+    void Set(int document_index);
+
+    void Reset(int document_index);
+
+    void Clear();
+
+    bool Test(int document_index) const {
+        return (words_[static_cast<size_t>(document_index) / kWordBits] >> (static_cast<size_t>(document_index) % kWordBits)) & 1u;
+    }
+
+    // number of set bits
+    size_t Count() const;
+
+    size_t size() const;
+
+    size_t GetMemoryUsage() const;
+
+private:
+    static constexpr size_t kWordBits = 64;
+
+private:
+    std::vector<std::uint64_t> words_;
+    size_t size_ = 0;
+    size_t count_ = 0;
+};
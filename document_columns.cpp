@@ -0,0 +1,70 @@
+#include "document_columns.h"
+
+void DocumentColumns::Append(int document_id, int rating, DocumentStatus status) {
+    ids_.push_back(document_id);
+    ratings_.push_back(rating);
+    statuses_.push_back(static_cast<std::uint8_t>(status));
+
+    for (DocumentBitmap& documents : status_documents_) {
+        documents.Resize(ids_.size());
+    }
+
+    status_documents_[static_cast<size_t>(status)].Set(static_cast<int>(ids_.size() - 1));
+} // Append
+
+void DocumentColumns::SetStatus(int document_index, DocumentStatus status) {
+    status_documents_[statuses_[document_index]].Reset(document_index);
+    status_documents_[static_cast<size_t>(status)].Set(document_index);
+
+    statuses_[document_index] = static_cast<std::uint8_t>(status);
+}
+
+void DocumentColumns::Compact(const DocumentBitmap& removed_documents) {
+    size_t kept_count = 0;
+
+    for (size_t document_index = 0; document_index < ids_.size(); ++document_index) {
+        if (removed_documents.Test(static_cast<int>(document_index))) {
+            continue;
+        }
+
+        ids_[kept_count] = ids_[document_index];
+        ratings_[kept_count] = ratings_[document_index];
+        statuses_[kept_count] = statuses_[document_index];
+        ++kept_count;
+    }
+
+    ids_.resize(kept_count);
+    ids_.shrink_to_fit();
+    ratings_.resize(kept_count);
+    ratings_.shrink_to_fit();
+    statuses_.resize(kept_count);
+    statuses_.shrink_to_fit();
+
+    // bitmaps only grow, so they are built anew at the new size
+    for (DocumentBitmap& documents : status_documents_) {
+        documents = DocumentBitmap();
+        documents.Resize(kept_count);
+    }
+
+    for (size_t document_index = 0; document_index < kept_count; ++document_index) {
+        status_documents_[statuses_[document_index]].Set(static_cast<int>(document_index));
+    }
+} // Compact
+
+size_t DocumentColumns::size() const {
+    return ids_.size();
+}
+
+bool DocumentColumns::empty() const {
+    return ids_.empty();
+}
+
+size_t DocumentColumns::GetMemoryUsage() const {
+    size_t memory_usage = ids_.capacity() * sizeof(int) + ratings_.capacity() * sizeof(int) + statuses_.capacity() * sizeof(std::uint8_t);
+
+    for (const DocumentBitmap& documents : status_documents_) {
+        memory_usage += documents.GetMemoryUsage();
+    }
+
+    return memory_usage;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "document.h"
+#include "document_bitmap.h"
+
+// Id, rating and status of every document by dense index, each in its own array,
+// so filtering a batch of candidates reads only the columns a predicate needs.
+// Documents of every status are also kept in a bitmap, so queries by status skip the others while walking postings.
+class DocumentColumns {
+public:
+    void Append(int document_id, int rating, DocumentStatus status);
+
+    // moves the document between the status bitmaps
+    void SetStatus(int document_index, DocumentStatus status);
+
+    // drops the documents set in the bitmap, the others get consecutive indexes in the same order
+    void Compact(const DocumentBitmap& removed_documents);
+
+    int GetId(int document_index) const {
+        return ids_[document_index];
+    }
+
+    int GetRating(int document_index) const {
+        return ratings_[document_index];
+    }
+
+    DocumentStatus GetStatus(int document_index) const {
+        return static_cast<DocumentStatus>(statuses_[document_index]);
+    }
+
+    // covers every appended document
+    const DocumentBitmap& GetStatusDocuments(DocumentStatus status) const {
+        return status_documents_[static_cast<size_t>(status)];
+    }
+
+    // Calls predicate(id, status, rating) for count documents and sets accepted[i] to its result.
+    // The loop does nothing else, so the predicate is evaluated straight from the columns.
+    template <typename Predicate>
+    void Filter(const int* document_indexes, size_t count, Predicate& predicate, bool* accepted) const;
+
+    size_t size() const;
+
+    bool empty() const;
+
+    size_t GetMemoryUsage() const;
+
+private:
+    std::vector<int> ids_;
+    std::vector<int> ratings_;
+    // a byte per document instead of the four of the enum
+    std::vector<std::uint8_t> statuses_;
+
+    std::array<DocumentBitmap, kDocumentStatusCount> status_documents_;
+};
+
+template <typename Predicate>
+void DocumentColumns::Filter(const int* document_indexes, size_t count, Predicate& predicate, bool* accepted) const {
+    for (size_t i = 0; i < count; ++i) {
+        const int document_index = document_indexes[i];
+
+        accepted[i] = predicate(ids_[document_index], static_cast<DocumentStatus>(statuses_[document_index]), ratings_[document_index]);
+    }
+}
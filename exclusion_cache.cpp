@@ -0,0 +1,101 @@
+#include "exclusion_cache.h"
+
+ExclusionCache::ExclusionCache(const ExclusionCache& other) {
+    *this = other;
+}
+
+ExclusionCache& ExclusionCache::operator=(const ExclusionCache& other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    std::unique_lock guard(mutex_, std::defer_lock);
+    std::shared_lock other_guard(other.mutex_, std::defer_lock);
+    std::lock(guard, other_guard);
+
+    // bitmaps are immutable, so copies share them
+    entries_.clear();
+
+    for (const auto& [term_id, other_entry] : other.entries_) {
+        Entry& entry = entries_[term_id];
+
+        entry.use_count.store(other_entry.use_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        entry.bitmap = other_entry.bitmap;
+    }
+
+    bitmap_count_ = other.bitmap_count_;
+
+    return *this;
+} // operator=
+
+void ExclusionCache::Clear() {
+    std::lock_guard guard(mutex_);
+
+    for (auto& [term_id, entry] : entries_) {
+        entry.bitmap.reset();
+    }
+
+    bitmap_count_ = 0;
+}
+
+size_t ExclusionCache::GetMemoryUsage() const {
+    std::shared_lock guard(mutex_);
+
+    size_t memory_usage = 0;
+
+    for (const auto& [term_id, entry] : entries_) {
+        if (entry.bitmap) {
+            memory_usage += entry.bitmap->GetMemoryUsage();
+        }
+    }
+
+    return memory_usage;
+} // GetMemoryUsage
+
+std::uint32_t ExclusionCache::CountUse(Entry& entry) {
+    std::uint32_t use_count = entry.use_count.load(std::memory_order_relaxed);
+
+    while (use_count < std::numeric_limits<std::uint32_t>::max()
+           && !entry.use_count.compare_exchange_weak(use_count, use_count + 1, std::memory_order_relaxed)) {
+    }
+
+    return use_count == std::numeric_limits<std::uint32_t>::max() ? use_count : use_count + 1;
+} // CountUse
+
+ExclusionCache::Entry* ExclusionCache::FindEvictionCandidate(std::uint32_t use_count) const {
+    Entry* candidate = nullptr;
+
+    for (auto& [term_id, entry] : entries_) {
+        if (entry.bitmap && (candidate == nullptr || entry.use_count.load(std::memory_order_relaxed)
+                                                     < candidate->use_count.load(std::memory_order_relaxed))) {
+            candidate = &entry;
+        }
+    }
+
+    if (candidate == nullptr || candidate->use_count.load(std::memory_order_relaxed) >= use_count) {
+        return nullptr;
+    }
+
+    return candidate;
+} // FindEvictionCandidate
+
+bool ExclusionCache::TakeSlot(std::uint32_t use_count) const {
+    if (bitmap_count_ < kMaxBitmapCount) {
+        ++bitmap_count_;
+        return true;
+    }
+
+    Entry* candidate = FindEvictionCandidate(use_count);
+
+    if (candidate == nullptr) {
+        return false;
+    }
+
+    candidate->bitmap.reset();
+
+    for (auto& [term_id, entry] : entries_) {
+        entry.use_count.store(entry.use_count.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+    }
+
+    return true;
+} // TakeSlot
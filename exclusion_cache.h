@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "document_bitmap.h"
+#include "term_dictionary.h"
+
+// Exclusion bitmaps of terms that queries often use as minus words. A bitmap covers the documents
+// indexed when it was built and is extended with the documents appended since. Lookups may run from
+// concurrent const queries: known terms are counted under a shared lock, and only new terms and new
+// bitmaps take the exclusive one. The bitmaps handed out stay valid while a query holds them.
+class ExclusionCache {
+public:
+    ExclusionCache() = default;
+
+    ExclusionCache(const ExclusionCache& other);
+
+    ExclusionCache& operator=(const ExclusionCache& other);
+
+public:
+    // Counts the use of the term as a minus word. Returns nothing until the term has been used
+    // kMinUseCount times, then a bitmap covering document_count documents. build(bitmap, first_document_index)
+    // sets the bits of documents from first_document_index on, the ones before are copied from the cached bitmap.
+    template <typename Build>
+    std::shared_ptr<const DocumentBitmap> Get(TermId term_id, size_t document_count, Build build) const;
+
+    // drops every bitmap once document indexes change, use counts are kept
+    void Clear();
+
+    size_t GetMemoryUsage() const;
+
+private:
+    static constexpr std::uint32_t kMinUseCount = 3;
+
+    // every bitmap costs a bit per document
+    static constexpr size_t kMaxBitmapCount = 64;
+
+private:
+    struct Entry {
+        // saturates instead of wrapping
+        std::atomic<std::uint32_t> use_count{0};
+        std::shared_ptr<const DocumentBitmap> bitmap;
+    };
+
+private:
+    // returns the new use count
+    static std::uint32_t CountUse(Entry& entry);
+
+    // the cached term a term used use_count times would evict, or none when it gets a free slot
+    // or no slot at all; the caller holds a lock
+    Entry* FindEvictionCandidate(std::uint32_t use_count) const;
+
+    // Under the exclusive lock. Takes a free slot or drops the bitmap of the least used term,
+    // unless every cached term is used more. Counts of all terms are halved on eviction,
+    // so terms that stopped coming lose their slots to the current ones.
+    bool TakeSlot(std::uint32_t use_count) const;
+
+private:
+    mutable std::shared_mutex mutex_;
+    mutable std::unordered_map<TermId, Entry> entries_;
+    mutable size_t bitmap_count_ = 0;
+};
+
+template <typename Build>
+std::shared_ptr<const DocumentBitmap> ExclusionCache::Get(TermId term_id, size_t document_count, Build build) const {
+    std::uint32_t use_count = 0;
+    std::shared_ptr<const DocumentBitmap> cached_bitmap;
+
+    {
+        std::shared_lock guard(mutex_);
+
+        const auto entry = entries_.find(term_id);
+
+        if (entry != entries_.end()) {
+            use_count = CountUse(entry->second);
+            cached_bitmap = entry->second.bitmap;
+        }
+    }
+
+    if (use_count == 0) {
+        std::lock_guard guard(mutex_);
+
+        use_count = CountUse(entries_[term_id]);
+    }
+
+    if (cached_bitmap && cached_bitmap->size() >= document_count) {
+        return cached_bitmap;
+    }
+
+    if (use_count < kMinUseCount) {
+        return nullptr;
+    }
+
+    if (!cached_bitmap) {
+        std::shared_lock guard(mutex_);
+
+        if (bitmap_count_ >= kMaxBitmapCount && FindEvictionCandidate(use_count) == nullptr) {
+            return nullptr;
+        }
+    }
+
+    // cached bitmaps are shared with running queries, so an outdated one is extended in a copy;
+    // concurrent queries may both build it, the bitmaps are equal
+    auto bitmap = cached_bitmap ? std::make_shared<DocumentBitmap>(*cached_bitmap) : std::make_shared<DocumentBitmap>();
+    const size_t first_document_index = bitmap->size();
+
+    bitmap->Resize(document_count);
+    build(*bitmap, static_cast<int>(first_document_index));
+
+    std::lock_guard guard(mutex_);
+
+    Entry& entry = entries_[term_id];
+
+    if (!entry.bitmap) {
+        // the slot may have gone to another term meanwhile, the bitmap still serves this query
+        if (!TakeSlot(use_count)) {
+            return bitmap;
+        }
+    } else if (entry.bitmap->size() >= bitmap->size()) {
+        return entry.bitmap;
+    }
+
+    entry.bitmap = std::move(bitmap);
+
+    return entry.bitmap;
+} // Get
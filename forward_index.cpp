@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "forward_index.h"
+
+using namespace std::literals;
+
+WordFrequencies::Iterator::Iterator(const TermDictionary* terms, const TermId* term_id, const double* term_frequency)
+    : terms_(terms), term_id_(term_id), term_frequency_(term_frequency) {
+}
+
+WordFrequencies::Iterator::value_type WordFrequencies::Iterator::operator*() const {
+    return {terms_->GetTerm(*term_id_), *term_frequency_};
+}
+
+WordFrequencies::Iterator& WordFrequencies::Iterator::operator++() {
+    ++term_id_;
+    ++term_frequency_;
+
+    return *this;
+}
+
+bool WordFrequencies::Iterator::operator==(const Iterator& other) const {
+    return term_id_ == other.term_id_;
+}
+
+bool WordFrequencies::Iterator::operator!=(const Iterator& other) const {
+    return term_id_ != other.term_id_;
+}
+
+WordFrequencies::WordFrequencies(const TermDictionary& terms, const TermId* term_ids, const double* term_frequencies, size_t size)
+    : terms_(&terms), term_ids_(term_ids), term_frequencies_(term_frequencies), size_(size) {
+}
+
+WordFrequencies::Iterator WordFrequencies::begin() const {
+    return Iterator(terms_, term_ids_, term_frequencies_);
+}
+
+WordFrequencies::Iterator WordFrequencies::end() const {
+    return Iterator(terms_, term_ids_ + size_, term_frequencies_ + size_);
+}
+
+size_t WordFrequencies::size() const {
+    return size_;
+}
+
+bool WordFrequencies::empty() const {
+    return size_ == 0;
+}
+
+size_t WordFrequencies::count(std::string_view word) const {
+    return FindPosition(word) ? 1 : 0;
+}
+
+double WordFrequencies::at(std::string_view word) const {
+    const std::optional<size_t> position = FindPosition(word);
+
+    if (!position) {
+        throw std::out_of_range("document does not contain the word"s);
+    }
+
+    return term_frequencies_[*position];
+}
+
+std::optional<size_t> WordFrequencies::FindPosition(std::string_view word) const {
+    if (size_ == 0) {
+        return std::nullopt;
+    }
+
+    const std::optional<TermId> term_id = terms_->Find(word);
+
+    if (!term_id) {
+        return std::nullopt;
+    }
+
+    const TermId* position = std::lower_bound(term_ids_, term_ids_ + size_, *term_id);
+
+    if (position == term_ids_ + size_ || *position != *term_id) {
+        return std::nullopt;
+    }
+
+    return static_cast<size_t>(position - term_ids_);
+} // FindPosition
+
+void ForwardIndex::Add(const std::vector<std::pair<TermId, double>>& term_frequencies) {
+    Add(term_frequencies.data(), term_frequencies.size());
+}
+
+void ForwardIndex::Add(const std::pair<TermId, double>* term_frequencies, size_t count) {
+    ranges_.push_back(Range{term_ids_.size(), count});
+
+    for (size_t i = 0; i < count; ++i) {
+        term_ids_.push_back(term_frequencies[i].first);
+        term_frequencies_.push_back(term_frequencies[i].second);
+    }
+} // Add
+
+void ForwardIndex::Remove(int document_index) {
+    ranges_[static_cast<size_t>(document_index)].size = 0;
+}
+
+void ForwardIndex::Compact(const DocumentBitmap& removed_documents) {
+    // documents are laid out in index order, so every one moves towards the front
+    size_t end = 0;
+    size_t kept_count = 0;
+
+    for (size_t document_index = 0; document_index < ranges_.size(); ++document_index) {
+        if (removed_documents.Test(static_cast<int>(document_index))) {
+            continue;
+        }
+
+        const Range range = ranges_[document_index];
+
+        if (range.begin != end) {
+            std::copy(term_ids_.begin() + range.begin, term_ids_.begin() + range.begin + range.size, term_ids_.begin() + end);
+            std::copy(term_frequencies_.begin() + range.begin, term_frequencies_.begin() + range.begin + range.size,
+                      term_frequencies_.begin() + end);
+        }
+
+        ranges_[kept_count++] = Range{end, range.size};
+        end += range.size;
+    }
+
+    ranges_.resize(kept_count);
+    ranges_.shrink_to_fit();
+
+    term_ids_.resize(end);
+    term_ids_.shrink_to_fit();
+    term_frequencies_.resize(end);
+    term_frequencies_.shrink_to_fit();
+} // Compact
+
+bool ForwardIndex::Contains(int document_index, TermId term_id) const {
+    const Range& range = ranges_[static_cast<size_t>(document_index)];
+
+    const auto begin = term_ids_.begin() + range.begin;
+    const auto end = begin + range.size;
+
+    return std::binary_search(begin, end, term_id);
+}
+
+WordFrequencies ForwardIndex::GetWordFrequencies(int document_index, const TermDictionary& terms) const {
+    const Range& range = ranges_[static_cast<size_t>(document_index)];
+
+    return WordFrequencies(terms, term_ids_.data() + range.begin, term_frequencies_.data() + range.begin, range.size);
+}
+
+size_t ForwardIndex::GetMemoryUsage() const {
+    return term_ids_.capacity() * sizeof(TermId) + term_frequencies_.capacity() * sizeof(double)
+        + ranges_.capacity() * sizeof(Range);
+}
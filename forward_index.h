@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "document_bitmap.h"
+#include "term_dictionary.h"
+
+// Read-only view of the words of one document with their term frequencies, ordered by term id.
+// The view and its iterators are valid until the next change of the index they were taken from,
+// iterators do not refer to the view itself.
+class WordFrequencies {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<std::string_view, double>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        Iterator(const TermDictionary* terms, const TermId* term_id, const double* term_frequency);
+
+        value_type operator*() const;
+
+        Iterator& operator++();
+
+        bool operator==(const Iterator& other) const;
+
+        bool operator!=(const Iterator& other) const;
+
+    private:
+        const TermDictionary* terms_;
+        const TermId* term_id_;
+        const double* term_frequency_;
+    };
+
+public:
+    WordFrequencies() = default;
+
+    WordFrequencies(const TermDictionary& terms, const TermId* term_ids, const double* term_frequencies, size_t size);
+
+public:
+    Iterator begin() const;
+
+    Iterator end() const;
+
+    size_t size() const;
+
+    bool empty() const;
+
+    size_t count(std::string_view word) const;
+
+    // throws std::out_of_range for words the document does not contain
+    double at(std::string_view word) const;
+
+private:
+    std::optional<size_t> FindPosition(std::string_view word) const;
+
+private:
+    const TermDictionary* terms_ = nullptr;
+    const TermId* term_ids_ = nullptr;
+    const double* term_frequencies_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Terms of every document as term ids sorted ascending with their term frequencies, packed
+// back to back into two arrays shared by all documents and addressed by dense document index.
+class ForwardIndex {
+public:
+    // documents get consecutive indexes, terms must be sorted by id without repeats
+    void Add(const std::vector<std::pair<TermId, double>>& term_frequencies);
+
+    // the same for a slice of a larger array
+    void Add(const std::pair<TermId, double>* term_frequencies, size_t count);
+
+    // the document keeps its index with no terms until Compact
+    void Remove(int document_index);
+
+    // Drops the documents set in the bitmap, the others move together over their space
+    // and get consecutive indexes in the same order.
+    void Compact(const DocumentBitmap& removed_documents);
+
+    bool Contains(int document_index, TermId term_id) const;
+
+    // function(TermId, double) in term id order
+    template <typename Function>
+    void ForEachTerm(int document_index, Function function) const;
+
+    WordFrequencies GetWordFrequencies(int document_index, const TermDictionary& terms) const;
+
+    size_t GetMemoryUsage() const;
+
+private:
+    struct Range {
+        size_t begin = 0;
+        size_t size = 0;
+    };
+
+private:
+    std::vector<TermId> term_ids_;
+    std::vector<double> term_frequencies_;
+
+    // indexed by document index
+    std::vector<Range> ranges_;
+};
+
+template <typename Function>
+void ForwardIndex::ForEachTerm(int document_index, Function function) const {
+    const Range& range = ranges_[static_cast<size_t>(document_index)];
+
+    for (size_t i = range.begin; i < range.begin + range.size; ++i) {
+        function(term_ids_[i], term_frequencies_[i]);
+    }
+} // ForEachTerm
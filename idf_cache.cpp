@@ -0,0 +1,59 @@
+#include <algorithm>
+
+#include "idf_cache.h"
+
+IdfCache::IdfCache(const IdfCache& other) {
+    *this = other;
+}
+
+IdfCache& IdfCache::operator=(const IdfCache& other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    entries_ = std::make_unique<Entry[]>(other.size_);
+    size_ = other.size_;
+    capacity_ = other.size_;
+
+    for (size_t i = 0; i < size_; ++i) {
+        entries_[i].generation.store(other.entries_[i].generation.load(std::memory_order_acquire), std::memory_order_relaxed);
+        entries_[i].inverse_document_frequency.store(other.entries_[i].inverse_document_frequency.load(std::memory_order_relaxed),
+                                                     std::memory_order_relaxed);
+    }
+
+    return *this;
+} // operator=
+
+void IdfCache::Resize(size_t term_count) {
+    if (term_count <= size_) {
+        return;
+    }
+
+    if (term_count > capacity_) {
+        // atomics cannot be moved, so a grown array is filled by hand
+        const size_t capacity = std::max(term_count, capacity_ * 2);
+        auto entries = std::make_unique<Entry[]>(capacity);
+
+        for (size_t i = 0; i < size_; ++i) {
+            entries[i].generation.store(entries_[i].generation.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            entries[i].inverse_document_frequency.store(entries_[i].inverse_document_frequency.load(std::memory_order_relaxed),
+                                                        std::memory_order_relaxed);
+        }
+
+        entries_ = std::move(entries);
+        capacity_ = capacity;
+    }
+
+    size_ = term_count;
+} // Resize
+
+void IdfCache::Set(TermId term_id, std::uint64_t generation, double inverse_document_frequency) const {
+    Entry& entry = entries_[term_id];
+
+    entry.inverse_document_frequency.store(inverse_document_frequency, std::memory_order_relaxed);
+    entry.generation.store(generation, std::memory_order_release);
+}
+
+size_t IdfCache::size() const {
+    return size_;
+}
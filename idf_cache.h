@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "term_dictionary.h"
+
+// Inverse document frequencies by term id, each stamped with the index generation it was
+// computed for. Stale entries are recomputed on first use. Lookups may run from concurrent
+// const queries, the generation only changes while the index is written and nobody reads.
+class IdfCache {
+public:
+    IdfCache() = default;
+
+    IdfCache(const IdfCache& other);
+
+    IdfCache& operator=(const IdfCache& other);
+
+    IdfCache(IdfCache&& other) = default;
+
+    IdfCache& operator=(IdfCache&& other) = default;
+
+public:
+    // generation 0 is never current, so new entries start stale
+    void Resize(size_t term_count);
+
+    // compute() is called only when the entry is stale
+    template <typename Compute>
+    double Get(TermId term_id, std::uint64_t generation, Compute compute) const;
+
+    void Set(TermId term_id, std::uint64_t generation, double inverse_document_frequency) const;
+
+    size_t size() const;
+
+private:
+    struct Entry {
+        std::atomic<std::uint64_t> generation{0};
+        std::atomic<double> inverse_document_frequency{0.0};
+    };
+
+private:
+    std::unique_ptr<Entry[]> entries_;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
+
+template <typename Compute>
+double IdfCache::Get(TermId term_id, std::uint64_t generation, Compute compute) const {
+    const Entry& entry = entries_[term_id];
+
+    // the acquire pairs with the release in Set, so the value is at least as new as its stamp
+    if (entry.generation.load(std::memory_order_acquire) == generation) {
+        return entry.inverse_document_frequency.load(std::memory_order_relaxed);
+    }
+
+    // concurrent queries may both compute it, they store the same value
+    const double inverse_document_frequency = compute();
+    Set(term_id, generation, inverse_document_frequency);
+
+    return inverse_document_frequency;
+} // Get
@@ -1,6 +1,7 @@
 #include "search_server.h"
 #include "process_queries.h"
 #include "test_search_server.h"
+#include "benchmarks.h"
 
 #include <iostream>
 #include <string>
@@ -8,9 +9,14 @@
 
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
     TestSearchServer();
 
+    if (argc > 1 && argv[1] == "--benchmark"s) {
+        benchmarks::RunBenchmarks();
+        return 0;
+    }
+
     SearchServer search_server("and with"s);
 
     int id = 0;
@@ -0,0 +1,27 @@
+#include <string>
+
+#include "memory_report.h"
+
+using namespace std::literals;
+
+long long MemoryReport::GetDictionarySavings() const {
+    return static_cast<long long>(string_key_bytes)
+        - static_cast<long long>(term_dictionary_bytes + term_id_bytes);
+}
+
+std::ostream& operator<<(std::ostream& output, const MemoryReport& report) {
+    output << "{ "s
+    << "terms = "s << report.term_count << ", "s
+    << "postings = "s << report.posting_count << ", "s
+    << "string keys = "s << report.string_key_bytes << " B, "s
+    << "term dictionary = "s << report.term_dictionary_bytes << " B, "s
+    << "term ids = "s << report.term_id_bytes << " B, "s
+    << "saved = "s << report.GetDictionarySavings() << " B, "s
+    << "forward index = "s << report.forward_index_bytes << " B, "s
+    << "document columns = "s << report.document_column_bytes << " B, "s
+    << "exclusion bitmaps = "s << report.exclusion_bitmap_bytes << " B, "s
+    << "posting lists = "s << report.posting_bytes << " B, "s
+    << "compressed posting lists = "s << report.compressed_posting_bytes << " B }"s;
+
+    return output;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+
+struct MemoryReport {
+    size_t term_count = 0;
+    size_t posting_count = 0;
+
+    // what the string-keyed inverted and forward maps spent on word keys
+    size_t string_key_bytes = 0;
+
+    size_t term_dictionary_bytes = 0;
+    size_t term_id_bytes = 0;
+
+    // term ids and frequencies of every document
+    size_t forward_index_bytes = 0;
+
+    // id, rating and status columns
+    size_t document_column_bytes = 0;
+
+    // cached for frequent minus words
+    size_t exclusion_bitmap_bytes = 0;
+
+    size_t posting_bytes = 0;
+    size_t compressed_posting_bytes = 0;
+
+    long long GetDictionarySavings() const;
+};
+
+std::ostream& operator<<(std::ostream& output, const MemoryReport& report);
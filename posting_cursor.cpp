@@ -0,0 +1,126 @@
+#include <algorithm>
+
+#include "posting_cursor.h"
+
+PostingCursor::PostingCursor(const PostingList& postings, const CompressedPostingList& compressed_postings) {
+    if (compressed_postings.empty()) {
+        postings_ = &postings;
+        block_count_ = postings.GetBlockCount();
+        max_term_frequency_ = postings.GetMaxTermFrequency();
+    } else {
+        compressed_postings_ = &compressed_postings;
+        block_count_ = compressed_postings.GetBlockCount();
+        max_term_frequency_ = compressed_postings.GetMaxTermFrequency();
+    }
+
+    LoadBlock(0);
+} // PostingCursor
+
+void PostingCursor::Next() {
+    if (document_id_ == kEndDocumentId) {
+        return;
+    }
+
+    if (++position_ < block_size_) {
+        document_id_ = block_document_ids_[position_];
+    } else {
+        LoadBlock(block_index_ + 1);
+    }
+} // Next
+
+void PostingCursor::NextGreaterOrEqual(int document_id) {
+    if (document_id <= document_id_) {
+        return;
+    }
+
+    size_t block_index = block_index_;
+    while (block_index < block_count_ && GetBlockLastDocumentId(block_index) < document_id) {
+        ++block_index;
+    }
+
+    if (block_index != block_index_) {
+        LoadBlock(block_index);
+
+        if (document_id_ == kEndDocumentId) {
+            return;
+        }
+    }
+
+    position_ = static_cast<size_t>(std::lower_bound(block_document_ids_ + position_, block_document_ids_ + block_size_, document_id)
+                                    - block_document_ids_);
+    document_id_ = block_document_ids_[position_];
+} // NextGreaterOrEqual
+
+void PostingCursor::ShallowSeek(int document_id) {
+    shallow_block_index_ = std::max(shallow_block_index_, block_index_);
+
+    while (shallow_block_index_ < block_count_ && GetBlockLastDocumentId(shallow_block_index_) < document_id) {
+        ++shallow_block_index_;
+    }
+} // ShallowSeek
+
+int PostingCursor::GetShallowBlockLastDocumentId() const {
+    if (shallow_block_index_ >= block_count_) {
+        return kEndDocumentId;
+    }
+
+    return GetBlockLastDocumentId(shallow_block_index_);
+}
+
+double PostingCursor::GetShallowBlockMaxTermFrequency() const {
+    if (shallow_block_index_ >= block_count_) {
+        return 0.0;
+    }
+
+    return GetBlockMaxTermFrequency(shallow_block_index_);
+}
+
+double PostingCursor::GetMaxTermFrequency() const {
+    return max_term_frequency_;
+}
+
+size_t PostingCursor::size() const {
+    return postings_ != nullptr ? postings_->size() : compressed_postings_->size();
+}
+
+int PostingCursor::GetBlockLastDocumentId(size_t block_index) const {
+    if (postings_ != nullptr) {
+        return postings_->GetBlockLastDocumentId(block_index);
+    }
+
+    return compressed_postings_->GetBlockHeader(block_index).last_document_id;
+}
+
+double PostingCursor::GetBlockMaxTermFrequency(size_t block_index) const {
+    if (postings_ != nullptr) {
+        return postings_->GetBlockMaxTermFrequency(block_index);
+    }
+
+    return compressed_postings_->GetBlockHeader(block_index).max_term_frequency;
+}
+
+void PostingCursor::LoadBlock(size_t block_index) {
+    block_index_ = block_index;
+    position_ = 0;
+
+    if (block_index >= block_count_) {
+        block_size_ = 0;
+        document_id_ = kEndDocumentId;
+
+        return;
+    }
+
+    if (postings_ != nullptr) {
+        const size_t offset = block_index * PostingList::kBlockSize;
+
+        block_document_ids_ = postings_->GetDocumentIds().data() + offset;
+        block_term_frequencies_ = postings_->GetTermFrequencies().data() + offset;
+        block_size_ = std::min(PostingList::kBlockSize, postings_->size() - offset);
+    } else {
+        block_size_ = compressed_postings_->DecodeBlock(block_index, decoded_document_ids_, decoded_term_frequencies_);
+        block_document_ids_ = decoded_document_ids_;
+        block_term_frequencies_ = decoded_term_frequencies_;
+    }
+
+    document_id_ = block_document_ids_[0];
+} // LoadBlock
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+#include "posting_list.h"
+#include "compressed_posting_list.h"
+
+// Forward-only iterator over the postings of one term in either storage format.
+// Besides regular skipping it can move a second, shallow pointer over block
+// headers without decoding, which is what dynamic pruning needs. Compressed
+// blocks are decoded into the cursor itself, so cursors are not copyable.
+class PostingCursor {
+public:
+    static constexpr int kEndDocumentId = std::numeric_limits<int>::max();
+
+public:
+    // iterates compressed_postings unless they are empty
+    PostingCursor(const PostingList& postings, const CompressedPostingList& compressed_postings);
+
+    PostingCursor(const PostingCursor&) = delete;
+
+    PostingCursor& operator=(const PostingCursor&) = delete;
+
+public:
+    int GetDocumentId() const {
+        return document_id_;
+    }
+
+    double GetTermFrequency() const {
+        return block_term_frequencies_[position_];
+    }
+
+    void Next();
+
+    // moves to the first posting with id not less than document_id
+    void NextGreaterOrEqual(int document_id);
+
+    // moves the shallow pointer to the block that may contain document_id
+    void ShallowSeek(int document_id);
+
+    int GetShallowBlockLastDocumentId() const;
+
+    double GetShallowBlockMaxTermFrequency() const;
+
+    double GetMaxTermFrequency() const;
+
+    size_t size() const;
+
+private:
+    int GetBlockLastDocumentId(size_t block_index) const;
+
+    double GetBlockMaxTermFrequency(size_t block_index) const;
+
+    void LoadBlock(size_t block_index);
+
+private:
+    const PostingList* postings_ = nullptr;
+    const CompressedPostingList* compressed_postings_ = nullptr;
+
+    size_t block_count_ = 0;
+    size_t block_index_ = 0;
+    size_t shallow_block_index_ = 0;
+
+    const int* block_document_ids_ = nullptr;
+    const double* block_term_frequencies_ = nullptr;
+    size_t block_size_ = 0;
+    size_t position_ = 0;
+
+    int document_id_ = kEndDocumentId;
+    double max_term_frequency_ = 0.0;
+
+    int decoded_document_ids_[CompressedPostingList::kBlockSize];
+    double decoded_term_frequencies_[CompressedPostingList::kBlockSize];
+};
@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <cassert>
+
+#include "posting_intersection.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAS_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// galloping wins once the longer array is this many times longer
+constexpr size_t kGallopingRatio = 32;
+
+size_t IntersectScalar(const int* left, size_t left_size, const int* right, size_t right_size, int* output) {
+    size_t i = 0;
+    size_t j = 0;
+    size_t count = 0;
+
+    while (i < left_size && j < right_size) {
+        if (left[i] < right[j]) {
+            ++i;
+        } else if (right[j] < left[i]) {
+            ++j;
+        } else {
+            output[count++] = left[i];
+            ++i;
+            ++j;
+        }
+    }
+
+    return count;
+} // IntersectScalar
+
+// the output follows the order of the left array, whichever of them is shorter
+size_t IntersectGalloping(const int* left, size_t left_size, const int* right, size_t right_size, int* output) {
+    const bool is_left_shorter = left_size <= right_size;
+
+    const int* shorter = is_left_shorter ? left : right;
+    const size_t shorter_size = is_left_shorter ? left_size : right_size;
+    const int* longer = is_left_shorter ? right : left;
+    const size_t longer_size = is_left_shorter ? right_size : left_size;
+
+    size_t position = 0;
+    size_t count = 0;
+
+    for (size_t i = 0; i < shorter_size && position < longer_size; ++i) {
+        const int document_id = shorter[i];
+
+        // doubles the step until it passes the id, then searches the last step
+        size_t step = 1;
+        while (position + step < longer_size && longer[position + step] < document_id) {
+            step *= 2;
+        }
+
+        position = static_cast<size_t>(std::lower_bound(longer + position + step / 2, longer + std::min(position + step + 1, longer_size),
+                                                        document_id) - longer);
+
+        if (position < longer_size && longer[position] == document_id) {
+            output[count++] = document_id;
+        }
+    }
+
+    return count;
+} // IntersectGalloping
+
+#ifdef HAS_X86_KERNELS
+
+// matched lanes are written one by one, so the output never runs ahead of the left array
+size_t WriteMatches(const int* block, unsigned mask, int* output) {
+    size_t count = 0;
+
+    while (mask != 0) {
+        output[count++] = block[__builtin_ctz(mask)];
+        mask &= mask - 1;
+    }
+
+    return count;
+}
+
+__attribute__((target("sse2")))
+size_t IntersectSse(const int* left, size_t left_size, const int* right, size_t right_size, int* output) {
+    constexpr size_t kLanes = 4;
+
+    size_t i = 0;
+    size_t j = 0;
+    size_t count = 0;
+
+    while (i + kLanes <= left_size && j + kLanes <= right_size) {
+        const __m128i left_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + i));
+        const __m128i right_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + j));
+
+        __m128i matches = _mm_cmpeq_epi32(left_block, right_block);
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi32(left_block, _mm_shuffle_epi32(right_block, _MM_SHUFFLE(0, 3, 2, 1))));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi32(left_block, _mm_shuffle_epi32(right_block, _MM_SHUFFLE(1, 0, 3, 2))));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi32(left_block, _mm_shuffle_epi32(right_block, _MM_SHUFFLE(2, 1, 0, 3))));
+
+        const int left_last = left[i + kLanes - 1];
+        const int right_last = right[j + kLanes - 1];
+
+        count += WriteMatches(left + i, static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(matches))), output + count);
+
+        if (left_last <= right_last) {
+            i += kLanes;
+        }
+        if (right_last <= left_last) {
+            j += kLanes;
+        }
+    }
+
+    return count + IntersectScalar(left + i, left_size - i, right + j, right_size - j, output + count);
+} // IntersectSse
+
+__attribute__((target("avx2")))
+size_t IntersectAvx2(const int* left, size_t left_size, const int* right, size_t right_size, int* output) {
+    constexpr size_t kLanes = 8;
+
+    const __m256i rotation = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+
+    size_t i = 0;
+    size_t j = 0;
+    size_t count = 0;
+
+    while (i + kLanes <= left_size && j + kLanes <= right_size) {
+        const __m256i left_block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + i));
+        __m256i right_block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + j));
+
+        __m256i matches = _mm256_cmpeq_epi32(left_block, right_block);
+        for (size_t k = 1; k < kLanes; ++k) {
+            right_block = _mm256_permutevar8x32_epi32(right_block, rotation);
+            matches = _mm256_or_si256(matches, _mm256_cmpeq_epi32(left_block, right_block));
+        }
+
+        const int left_last = left[i + kLanes - 1];
+        const int right_last = right[j + kLanes - 1];
+
+        count += WriteMatches(left + i, static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(matches))), output + count);
+
+        if (left_last <= right_last) {
+            i += kLanes;
+        }
+        if (right_last <= left_last) {
+            j += kLanes;
+        }
+    }
+
+    return count + IntersectSse(left + i, left_size - i, right + j, right_size - j, output + count);
+} // IntersectAvx2
+
+#endif
+
+} // namespace
+
+bool IsSupported(IntersectionKernel kernel) {
+    switch (kernel) {
+        case IntersectionKernel::scalar:
+        case IntersectionKernel::galloping:
+            return true;
+#ifdef HAS_X86_KERNELS
+        case IntersectionKernel::sse:
+            return __builtin_cpu_supports("sse2");
+        case IntersectionKernel::avx2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+} // IsSupported
+
+IntersectionKernel GetBestIntersectionKernel() {
+    static const IntersectionKernel best_kernel = IsSupported(IntersectionKernel::avx2) ? IntersectionKernel::avx2
+                                                : IsSupported(IntersectionKernel::sse)  ? IntersectionKernel::sse
+                                                                                        : IntersectionKernel::scalar;
+
+    return best_kernel;
+}
+
+size_t IntersectDocumentIds(IntersectionKernel kernel, const int* left, size_t left_size,
+                            const int* right, size_t right_size, int* output) {
+    assert(IsSupported(kernel));
+
+    switch (kernel) {
+        case IntersectionKernel::galloping:
+            return IntersectGalloping(left, left_size, right, right_size, output);
+#ifdef HAS_X86_KERNELS
+        case IntersectionKernel::sse:
+            return IntersectSse(left, left_size, right, right_size, output);
+        case IntersectionKernel::avx2:
+            return IntersectAvx2(left, left_size, right, right_size, output);
+#endif
+        default:
+            return IntersectScalar(left, left_size, right, right_size, output);
+    }
+} // IntersectDocumentIds
+
+size_t IntersectDocumentIds(const int* left, size_t left_size, const int* right, size_t right_size, int* output) {
+    if (std::max(left_size, right_size) > kGallopingRatio * std::min(left_size, right_size)) {
+        return IntersectGalloping(left, left_size, right, right_size, output);
+    }
+
+    return IntersectDocumentIds(GetBestIntersectionKernel(), left, left_size, right, right_size, output);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+
+// Intersection of sorted arrays of unique document ids. The SIMD kernels compare
+// blocks of ids against every rotation of a block of the other array, the galloping
+// one searches the longer array for each id of a much shorter one.
+enum class IntersectionKernel {
+    scalar, galloping, sse, avx2
+};
+
+// whether the processor can run the kernel
+bool IsSupported(IntersectionKernel kernel);
+
+// widest supported SIMD kernel, checked once with CPUID
+IntersectionKernel GetBestIntersectionKernel();
+
+// Writes the common ids to output and returns their count. Output must fit the shorter
+// array and may be the left one, which is how a list is narrowed down in place.
+size_t IntersectDocumentIds(IntersectionKernel kernel, const int* left, size_t left_size,
+                            const int* right, size_t right_size, int* output);
+
+// gallops when one array is much longer, otherwise runs the best kernel
+size_t IntersectDocumentIds(const int* left, size_t left_size, const int* right, size_t right_size, int* output);
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <iterator>
+
+#include "posting_list.h"
+
+void PostingList::Add(int document_id, double term_frequency) {
+    if (document_ids_.empty() || document_ids_.back() < document_id) {
+        document_ids_.push_back(document_id);
+        term_frequencies_.push_back(term_frequency);
+
+        if (block_max_term_frequencies_.size() < GetBlockCount()) {
+            block_max_term_frequencies_.push_back(term_frequency);
+        } else {
+            block_max_term_frequencies_.back() = std::max(block_max_term_frequencies_.back(), term_frequency);
+        }
+
+        max_term_frequency_ = std::max(max_term_frequency_, term_frequency);
+
+        return;
+    }
+
+    const auto position = std::lower_bound(document_ids_.begin(), document_ids_.end(), document_id);
+    const auto offset = std::distance(document_ids_.begin(), position);
+
+    if (position != document_ids_.end() && *position == document_id) {
+        term_frequencies_[offset] = term_frequency;
+        UpdateBlockMaxima(static_cast<size_t>(offset));
+
+        return;
+    }
+
+    document_ids_.insert(position, document_id);
+    term_frequencies_.insert(term_frequencies_.begin() + offset, term_frequency);
+    UpdateBlockMaxima(static_cast<size_t>(offset));
+} // Add
+
+bool PostingList::Remove(int document_id) {
+    const auto position = std::lower_bound(document_ids_.begin(), document_ids_.end(), document_id);
+
+    if (position == document_ids_.end() || *position != document_id) {
+        return false;
+    }
+
+    const auto offset = std::distance(document_ids_.begin(), position);
+
+    document_ids_.erase(position);
+    term_frequencies_.erase(term_frequencies_.begin() + offset);
+    UpdateBlockMaxima(static_cast<size_t>(offset));
+
+    return true;
+} // Remove
+
+size_t PostingList::Renumber(const std::vector<int>& new_document_ids) {
+    size_t kept_count = 0;
+    size_t first_removed_position = document_ids_.size();
+
+    for (size_t position = 0; position < document_ids_.size(); ++position) {
+        const int new_document_id = new_document_ids[static_cast<size_t>(document_ids_[position])];
+
+        if (new_document_id < 0) {
+            first_removed_position = std::min(first_removed_position, position);
+            continue;
+        }
+
+        document_ids_[kept_count] = new_document_id;
+        term_frequencies_[kept_count] = term_frequencies_[position];
+        ++kept_count;
+    }
+
+    const size_t removed_count = document_ids_.size() - kept_count;
+
+    if (removed_count > 0) {
+        document_ids_.resize(kept_count);
+        term_frequencies_.resize(kept_count);
+        UpdateBlockMaxima(first_removed_position);
+    }
+
+    return removed_count;
+} // Renumber
+
+bool PostingList::Contains(int document_id) const {
+    return std::binary_search(document_ids_.begin(), document_ids_.end(), document_id);
+}
+
+size_t PostingList::size() const {
+    return document_ids_.size();
+}
+
+bool PostingList::empty() const {
+    return document_ids_.empty();
+}
+
+const std::vector<int>& PostingList::GetDocumentIds() const {
+    return document_ids_;
+}
+
+const std::vector<double>& PostingList::GetTermFrequencies() const {
+    return term_frequencies_;
+}
+
+size_t PostingList::GetBlockCount() const {
+    return (document_ids_.size() + kBlockSize - 1) / kBlockSize;
+}
+
+int PostingList::GetBlockLastDocumentId(size_t block_index) const {
+    return document_ids_[std::min((block_index + 1) * kBlockSize, document_ids_.size()) - 1];
+}
+
+double PostingList::GetBlockMaxTermFrequency(size_t block_index) const {
+    return block_max_term_frequencies_[block_index];
+}
+
+double PostingList::GetMaxTermFrequency() const {
+    return max_term_frequency_;
+}
+
+size_t PostingList::GetMemoryUsage() const {
+    return document_ids_.capacity() * sizeof(int)
+        + term_frequencies_.capacity() * sizeof(double)
+        + block_max_term_frequencies_.capacity() * sizeof(double);
+}
+
+// inserting or erasing in the middle shifts every following posting into another block
+void PostingList::UpdateBlockMaxima(size_t first_changed_position) {
+    block_max_term_frequencies_.resize(GetBlockCount());
+
+    for (size_t block_index = first_changed_position / kBlockSize; block_index < GetBlockCount(); ++block_index) {
+        const auto block_begin = term_frequencies_.begin() + block_index * kBlockSize;
+        const auto block_end = term_frequencies_.begin() + std::min((block_index + 1) * kBlockSize, term_frequencies_.size());
+
+        block_max_term_frequencies_[block_index] = *std::max_element(block_begin, block_end);
+    }
+
+    // a changed frequency may have been the maximum, the blocks before it still count
+    max_term_frequency_ = block_max_term_frequencies_.empty()
+                        ? 0.0
+                        : *std::max_element(block_max_term_frequencies_.begin(), block_max_term_frequencies_.end());
+} // UpdateBlockMaxima
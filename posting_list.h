@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "document_bitmap.h"
+
+// Postings of one term as two parallel arrays sorted by document id.
+// Every kBlockSize postings form a block with its maximal term frequency tracked.
+class PostingList {
+public:
+    static constexpr size_t kBlockSize = 128;
+
+public:
+    // appending a document id greater than every stored one is O(1)
+    void Add(int document_id, double term_frequency);
+
+    bool Remove(int document_id);
+
+    // Drops postings of documents mapped to a negative id in one pass and gives the rest their new ids,
+    // returns how many were dropped. The map must keep the order of the documents it keeps.
+    size_t Renumber(const std::vector<int>& new_document_ids);
+
+    bool Contains(int document_id) const;
+
+    size_t size() const;
+
+    bool empty() const;
+
+    const std::vector<int>& GetDocumentIds() const;
+
+    const std::vector<double>& GetTermFrequencies() const;
+
+    size_t GetBlockCount() const;
+
+    int GetBlockLastDocumentId(size_t block_index) const;
+
+    double GetBlockMaxTermFrequency(size_t block_index) const;
+
+    // kept up to date by every change, so cursors read it without walking the blocks
+    double GetMaxTermFrequency() const;
+
+    size_t GetMemoryUsage() const;
+
+private:
+    void UpdateBlockMaxima(size_t first_changed_position);
+
+private:
+    std::vector<int> document_ids_;
+    std::vector<double> term_frequencies_;
+    std::vector<double> block_max_term_frequencies_;
+    double max_term_frequency_ = 0.0;
+};
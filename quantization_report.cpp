@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include "quantization_report.h"
+
+using namespace std::literals;
+
+double QuantizationReport::GetChangedTopShare() const {
+    return query_count > 0 ? static_cast<double>(changed_top_count) / static_cast<double>(query_count) : 0.0;
+}
+
+std::ostream& operator<<(std::ostream& output, const QuantizationReport& report) {
+    output << "{ "s
+    << "queries = "s << report.query_count << ", "s
+    << "changed tops = "s << report.changed_top_count << ", "s
+    << "reordered tops = "s << report.reordered_top_count << ", "s
+    << "max relevance error = "s << report.max_relevance_error << " }"s;
+
+    return output;
+}
+
+QuantizationReport MeasureQuantization(const SearchServer& search_server, const std::vector<std::string>& queries,
+                                       Quantization quantization, int max_result_document_count) {
+    SearchServer quantized_search_server = search_server;
+    quantized_search_server.CompressPostings(Policy::parallel, quantization);
+
+    SearchOptions options;
+    options.max_result_document_count = max_result_document_count;
+
+    QuantizationReport report;
+
+    for (const std::string& query : queries) {
+        const std::vector<Document> exact_documents = search_server.FindTopDocuments(options, query);
+        const std::vector<Document> quantized_documents = quantized_search_server.FindTopDocuments(options, query);
+
+        ++report.query_count;
+
+        std::map<int, double> exact_relevances;
+        for (const Document& document : exact_documents) {
+            exact_relevances.emplace(document.id, document.relevance);
+        }
+
+        bool is_same_set = exact_documents.size() == quantized_documents.size();
+        bool is_same_order = is_same_set;
+
+        for (size_t i = 0; i < quantized_documents.size(); ++i) {
+            const auto exact_relevance = exact_relevances.find(quantized_documents[i].id);
+
+            if (exact_relevance == exact_relevances.end()) {
+                is_same_set = false;
+                continue;
+            }
+
+            report.max_relevance_error = std::max(report.max_relevance_error,
+                                                  std::abs(exact_relevance->second - quantized_documents[i].relevance));
+
+            if (i >= exact_documents.size() || exact_documents[i].id != quantized_documents[i].id) {
+                is_same_order = false;
+            }
+        }
+
+        if (!is_same_set) {
+            ++report.changed_top_count;
+        } else if (!is_same_order) {
+            ++report.reordered_top_count;
+        }
+    }
+
+    return report;
+} // MeasureQuantization
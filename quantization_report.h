@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "search_server.h"
+
+struct QuantizationReport {
+    size_t query_count = 0;
+
+    // queries whose top documents are not the same set as with exact term frequencies
+    size_t changed_top_count = 0;
+
+    // queries with the same top documents in a different order
+    size_t reordered_top_count = 0;
+
+    // over documents found in both tops
+    double max_relevance_error = 0.0;
+
+    double GetChangedTopShare() const;
+};
+
+std::ostream& operator<<(std::ostream& output, const QuantizationReport& report);
+
+// Ranks every query on a plain copy and on a copy compressed with the quantization and
+// compares their top documents. The server itself should hold plain postings.
+QuantizationReport MeasureQuantization(const SearchServer& search_server, const std::vector<std::string>& queries,
+                                       Quantization quantization, int max_result_document_count = 5);
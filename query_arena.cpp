@@ -0,0 +1,65 @@
+#include <algorithm>
+
+#include "query_arena.h"
+
+QueryArena::Scope::Scope() : arena_(GetThreadArena()) {
+    ++arena_.scope_depth_;
+}
+
+QueryArena::Scope::~Scope() {
+    if (--arena_.scope_depth_ == 0) {
+        arena_.Release();
+    }
+}
+
+std::pmr::memory_resource* QueryArena::Scope::GetResource() const {
+    return &*arena_.resource_;
+}
+
+QueryArena& QueryArena::GetThreadArena() {
+    thread_local QueryArena arena;
+
+    return arena;
+}
+
+size_t QueryArena::GetCapacity() const {
+    return buffer_.size();
+}
+
+size_t QueryArena::OverflowResource::GetAllocatedBytes() const {
+    return allocated_bytes_;
+}
+
+void QueryArena::OverflowResource::ResetAllocatedBytes() {
+    allocated_bytes_ = 0;
+}
+
+void* QueryArena::OverflowResource::do_allocate(size_t bytes, size_t alignment) {
+    allocated_bytes_ += bytes;
+
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void QueryArena::OverflowResource::do_deallocate(void* pointer, size_t bytes, size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+}
+
+bool QueryArena::OverflowResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+QueryArena::QueryArena() : buffer_(kInitialCapacity) {
+    resource_.emplace(buffer_.data(), buffer_.size(), &overflow_);
+}
+
+void QueryArena::Release() {
+    // frees the overflow blocks
+    resource_.reset();
+
+    if (overflow_.GetAllocatedBytes() > 0) {
+        buffer_.assign(std::max(buffer_.size() * 2, buffer_.size() + overflow_.GetAllocatedBytes()), std::byte{0});
+        overflow_.ResetAllocatedBytes();
+    }
+
+    resource_.emplace(buffer_.data(), buffer_.size(), &overflow_);
+} // Release
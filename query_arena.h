@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+// Per-thread memory for the temporaries of a query. Everything taken from it is
+// released at once when the query ends, and the buffer grows to fit the largest
+// query seen so far, so a steady query load does not touch the heap.
+class QueryArena {
+public:
+    // Marks the lifetime of the temporaries of one query on the calling thread. Scopes nest,
+    // memory is released when the outermost one ends, after every container using it is gone.
+    class Scope {
+    public:
+        Scope();
+
+        Scope(const Scope&) = delete;
+
+        Scope& operator=(const Scope&) = delete;
+
+        ~Scope();
+
+    public:
+        std::pmr::memory_resource* GetResource() const;
+
+    private:
+        QueryArena& arena_;
+    };
+
+public:
+    static QueryArena& GetThreadArena();
+
+    // bytes the next query may take without going to the heap
+    size_t GetCapacity() const;
+
+private:
+    static constexpr size_t kInitialCapacity = 16 * 1024;
+
+private:
+    // the heap behind the buffer, counting what queries took from it
+    class OverflowResource : public std::pmr::memory_resource {
+    public:
+        size_t GetAllocatedBytes() const;
+
+        void ResetAllocatedBytes();
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+
+        void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    private:
+        size_t allocated_bytes_ = 0;
+    };
+
+private:
+    QueryArena();
+
+    // gives all memory back and grows the buffer if the query did not fit
+    void Release();
+
+private:
+    std::vector<std::byte> buffer_;
+    OverflowResource overflow_;
+    std::optional<std::pmr::monotonic_buffer_resource> resource_;
+
+    int scope_depth_ = 0;
+};
@@ -0,0 +1,19 @@
+#include "relevance_accumulator.h"
+
+void RelevanceAccumulator::Reset(size_t document_count) {
+    for (const int document_index : touched_) {
+        relevances_[document_index] = 0.0;
+        states_[document_index] = State::untouched;
+    }
+
+    touched_.clear();
+
+    if (relevances_.size() < document_count) {
+        relevances_.resize(document_count, 0.0);
+        states_.resize(document_count, State::untouched);
+    }
+} // Reset
+
+size_t RelevanceAccumulator::GetTouchedCount() const {
+    return touched_.size();
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Flat relevance array over dense document indexes. Only touched slots are
+// visited and reset, so one accumulator can be reused across queries.
+class RelevanceAccumulator {
+public:
+    // grows the arrays to cover document_count indexes and forgets the previous query
+    void Reset(size_t document_count);
+
+    // excluded documents are not accumulated, so minus words are best excluded first
+    void Add(int document_index, double relevance) {
+        if (states_[document_index] == State::excluded) {
+            return;
+        }
+
+        if (states_[document_index] == State::untouched) {
+            states_[document_index] = State::matched;
+            touched_.push_back(document_index);
+        }
+
+        relevances_[document_index] += relevance;
+    }
+
+    void Exclude(int document_index) {
+        if (states_[document_index] == State::untouched) {
+            touched_.push_back(document_index);
+        }
+
+        states_[document_index] = State::excluded;
+    }
+
+    // calls function(document_index, relevance) for every matched and not excluded document
+    template <typename Function>
+    void ForEachMatched(Function function) const {
+        for (const int document_index : touched_) {
+            if (states_[document_index] == State::matched) {
+                function(document_index, relevances_[document_index]);
+            }
+        }
+    }
+
+    size_t GetTouchedCount() const;
+
+private:
+    enum class State : std::uint8_t {
+        untouched, matched, excluded
+    };
+
+private:
+    std::vector<double> relevances_;
+    std::vector<State> states_;
+    std::vector<int> touched_;
+};
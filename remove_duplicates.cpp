@@ -2,6 +2,7 @@
 
 #include <set>
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <vector>
 
@@ -10,14 +11,14 @@ using namespace std::literals;
 namespace remove_duplicates {
 
 void RemoveDuplicates(SearchServer& search_server) {
-    std::set<std::set<std::string>> unique_documents;
+    std::set<std::set<std::string_view>> unique_documents;
     
     std::vector<int> duplicate_document_ids;
     
     for (const int document_id : search_server) {
         const auto words_to_term_frequencies = search_server.GetWordFrequencies(document_id);
         
-        std::set<std::string> words_in_document;
+        std::set<std::string_view> words_in_document;
         
         for (const auto& [word, term_frequency] : words_to_term_frequencies) {
             words_in_document.insert(word);
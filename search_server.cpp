@@ -2,6 +2,8 @@
 #include <cmath>
 #include <algorithm>
 #include <execution>
+#include <numeric>
+#include <thread>
 #include <utility>
 
 #include "search_server.h"
@@ -19,60 +21,43 @@ std::set<int>::const_iterator SearchServer::end() const {
     return document_ids_.end();
 }
 
-const std::map<std::string, double>& SearchServer::GetWordFrequencies(int document_id) const {
-    const static std::map<std::string, double> empty_map;
+WordFrequencies SearchServer::GetWordFrequencies(int document_id) const {
+    const auto document_index = document_id_to_index_.find(document_id);
     
-    if (document_id_to_document_data_.count(document_id) > 0) {
-        return document_id_to_document_data_.at(document_id).word_frequencies;
+    if (document_index == document_id_to_index_.end()) {
+        return WordFrequencies();
     }
     
-    return empty_map;
+    return forward_index_.GetWordFrequencies(document_index->second, terms_);
 }
 
 void SearchServer::RemoveDocument(int document_id, Policy policy) {
-    if (document_id_to_document_data_.count(document_id) == 0) {
+    if (document_id_to_index_.count(document_id) == 0) {
         return;
     }
 
-    // get list of words that are in this doc
-    const auto words_and_frequencies = GetWordFrequencies(document_id);
-
-    // initialize linear container that will contain inner maps where id point to frequency
-    std::vector<std::map<int, double>> id_to_frequency;
-    id_to_frequency.reserve(words_and_frequencies.size());
-
-    // populate this inner container
-    for (const auto& [word, term_frequency] : words_and_frequencies) {
-        id_to_frequency.push_back(std::move(word_to_document_id_to_term_frequency_.at(word)));
-    }
-
-    // change inner maps
-    if (policy == Policy::parallel) {
-        std::for_each(std::execution::par, id_to_frequency.begin(), id_to_frequency.end(), [document_id](std::map<int, double>& element){
-            element.erase(document_id);
-        });
-
-    } else {
-        std::for_each(std::execution::seq, id_to_frequency.begin(), id_to_frequency.end(), [document_id](std::map<int, double>& element){
-            element.erase(document_id);
-        }); 
-    }
-
-    // and put them back
-    auto it = id_to_frequency.begin();
-    for (const auto& [word, term_frequency] : words_and_frequencies) {
-        word_to_document_id_to_term_frequency_.at(word) = std::move(*(it++));
-        
-        if (word_to_document_id_to_term_frequency_.at(word).empty()) {
-            word_to_document_id_to_term_frequency_.erase(word);
-        }
-    }
-
-// not parallel
-    document_id_to_document_data_.erase(document_id);
+    const int document_index = document_id_to_index_.at(document_id);
+    
+    forward_index_.ForEachTerm(document_index, [this](TermId term_id, double) {
+        --document_frequencies_[term_id];
+    });
+    
+    forward_index_.Remove(document_index);
+    
+    deleted_documents_.Set(document_index);
+    
+    InvalidateStatistics();
+    
+    document_id_to_index_.erase(document_id);
     
     document_ids_.erase(document_id);
-}
+    
+    const size_t indexed_document_count = document_id_to_index_.size() + deleted_documents_.Count();
+    
+    if (static_cast<double>(deleted_documents_.Count()) > max_deleted_ratio_ * static_cast<double>(indexed_document_count)) {
+        CompactPostings(policy);
+    }
+} // RemoveDocument
 
 void SearchServer::RemoveDocument(std::execution::sequenced_policy p, int document_id) {
     RemoveDocument(document_id, Policy::sequential);
@@ -83,130 +68,474 @@ void SearchServer::RemoveDocument(std::execution::parallel_policy p, int documen
 }
 
 SearchServer::SearchServer(const std::string& stop_words) {
-    if (!IsValidWord(stop_words)) {
-        throw std::invalid_argument("stop word contains unaccaptable symbol"s);
-    }
-    
     SetStopWords(stop_words);
 }
 
 SearchServer::SearchServer(const std::string_view stop_words) {
-    if (!IsValidWord(stop_words)) {
-        throw std::invalid_argument("stop word contains unaccaptable symbol"s);
-    }
-    
     SetStopWords(stop_words);
 }
 
 void SearchServer::SetStopWords(std::string_view text) {
-    for (const std::string_view word : string_processing::SplitIntoWords(text)) {
-        if (!IsValidWord(word)) {
-            throw std::invalid_argument("Bad stop word");
-        }
-        
-        stop_words_.emplace(word);
+    std::vector<std::string_view> words;
+    if (!string_processing::SplitIntoValidWords(text, words)) {
+        throw std::invalid_argument("stop word contains unaccaptable symbol"s);
+    }
+    
+    for (const std::string_view word : words) {
+        stop_words_.Insert(word);
     }
 } // SetStopWords
 
+void SearchServer::SetDocumentStatus(int document_id, DocumentStatus status) {
+    const auto document_index = document_id_to_index_.find(document_id);
+    
+    if (document_index == document_id_to_index_.end()) {
+        return;
+    }
+    
+    documents_.SetStatus(document_index->second, status);
+}
+
 bool SearchServer::AddDocument(int document_id, const std::string& document,
                                DocumentStatus status, const std::vector<int>& ratings) {
     if (document_id < 0) {
         throw std::invalid_argument("negative ids are not allowed"s);
     }
     
-    if (document_id_to_document_data_.count(document_id) > 0) {
+    if (document_id_to_index_.count(document_id) > 0) {
         throw std::invalid_argument("repeating ids are not allowed"s);
     }
     
-    if (!IsValidWord(document)) {
+    std::vector<std::string_view> words;
+    if (!string_processing::SplitIntoValidWords(document, words)) {
         throw std::invalid_argument("word in document contains unaccaptable symbol"s);
     }
     
-    const std::vector<std::string> words = SplitIntoWordsNoStop(document);
+    std::vector<TermId> term_ids;
+    term_ids.reserve(words.size());
+    
+    for (const std::string_view word : words) {
+        if (!IsStopWord(word)) {
+            term_ids.push_back(terms_.Intern(word));
+        }
+    }
     
-    const double inverse_word_count = 1.0 / static_cast<double>(words.size());
+    std::sort(term_ids.begin(), term_ids.end());
     
-    std::map<std::string, double> word_frequencies;
+    AppendDocument(document_id, ComputeAverageRating(ratings), status, CountTermFrequencies(term_ids));
     
-    for (const std::string& word : words) {
-        word_to_document_id_to_term_frequency_[word][document_id] += inverse_word_count;
-        word_frequencies[word] += inverse_word_count;
+    return true;
+} // AddDocument
+
+void SearchServer::AddDocuments(const std::vector<NewDocument>& documents, Policy policy) {
+    std::set<int> batch_document_ids;
+    
+    for (const NewDocument& document : documents) {
+        if (document.id < 0) {
+            throw std::invalid_argument("negative ids are not allowed"s);
+        }
+        
+        if (document_id_to_index_.count(document.id) > 0 || !batch_document_ids.insert(document.id).second) {
+            throw std::invalid_argument("repeating ids are not allowed"s);
+        }
+    }
+    
+    // one chunk per thread keeps chunk dictionaries few and large
+    const size_t chunk_count = policy == Policy::parallel
+                             ? std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), documents.size()))
+                             : 1;
+    
+    const auto chunk_begin = [&documents, chunk_count](size_t chunk_index) {
+        return documents.begin() + documents.size() * chunk_index / chunk_count;
+    };
+    
+    std::vector<PartialIndex> chunks(chunk_count);
+    std::vector<size_t> chunk_indexes(chunk_count);
+    std::iota(chunk_indexes.begin(), chunk_indexes.end(), size_t{0});
+    
+    const auto build_chunk = [this, &chunks, &chunk_begin](size_t chunk_index) {
+        chunks[chunk_index] = BuildPartialIndex(chunk_begin(chunk_index), chunk_begin(chunk_index + 1));
+    };
+    
+    const auto renumber_chunk = [&chunks](size_t chunk_index) {
+        RenumberPartialIndex(chunks[chunk_index]);
+    };
+    
+    if (policy == Policy::parallel) {
+        std::for_each(std::execution::par, chunk_indexes.begin(), chunk_indexes.end(), build_chunk);
+    } else {
+        std::for_each(std::execution::seq, chunk_indexes.begin(), chunk_indexes.end(), build_chunk);
+    }
+    
+    // texts are validated while indexed, nothing is added yet
+    for (const PartialIndex& chunk : chunks) {
+        if (!chunk.is_valid) {
+            throw std::invalid_argument("word in document contains unaccaptable symbol"s);
+        }
+    }
+    
+    // chunk terms are interned in batch order, so they get the ids adding the documents one by one would give
+    for (PartialIndex& chunk : chunks) {
+        chunk.term_ids.resize(chunk.terms.GetTermCount());
+        
+        for (TermId chunk_term_id = 0; chunk_term_id < chunk.term_ids.size(); ++chunk_term_id) {
+            chunk.term_ids[chunk_term_id] = terms_.Intern(chunk.terms.GetTerm(chunk_term_id));
+        }
+    }
+    
+    if (policy == Policy::parallel) {
+        std::for_each(std::execution::par, chunk_indexes.begin(), chunk_indexes.end(), renumber_chunk);
+    } else {
+        std::for_each(std::execution::seq, chunk_indexes.begin(), chunk_indexes.end(), renumber_chunk);
+    }
+    
+    for (size_t chunk_index = 0; chunk_index < chunk_count; ++chunk_index) {
+        AppendPartialIndex(chunks[chunk_index], chunk_begin(chunk_index));
+    }
+} // AddDocuments
+
+SearchServer::PartialIndex SearchServer::BuildPartialIndex(std::vector<NewDocument>::const_iterator begin,
+                                                           std::vector<NewDocument>::const_iterator end) const {
+    PartialIndex partial_index;
+    partial_index.document_ends.reserve(static_cast<size_t>(end - begin));
+    
+    std::vector<TermId> document_term_ids;
+    std::vector<std::string_view> words;
+    
+    for (auto document = begin; document != end; ++document) {
+        document_term_ids.clear();
+        
+        if (!string_processing::SplitIntoValidWords(document->text, words)) {
+            partial_index.is_valid = false;
+            return partial_index;
+        }
+        
+        for (const std::string_view word : words) {
+            if (!IsStopWord(word)) {
+                document_term_ids.push_back(partial_index.terms.Intern(word));
+            }
+        }
+        
+        std::sort(document_term_ids.begin(), document_term_ids.end());
+        
+        const double inverse_word_count = 1.0 / static_cast<double>(document_term_ids.size());
+        const size_t document_begin = partial_index.term_frequencies.size();
+        
+        // equal terms are adjacent and are counted in one go
+        for (const TermId term_id : document_term_ids) {
+            if (partial_index.term_frequencies.size() == document_begin || partial_index.term_frequencies.back().first != term_id) {
+                partial_index.term_frequencies.emplace_back(term_id, 0.0);
+            }
+            
+            partial_index.term_frequencies.back().second += inverse_word_count;
+        }
+        
+        partial_index.document_ends.push_back(partial_index.term_frequencies.size());
+    }
+    
+    // postings are packed by term with a counting sort, documents stay in chunk order within a term
+    const size_t term_count = partial_index.terms.GetTermCount();
+    const size_t posting_count = partial_index.term_frequencies.size();
+    
+    partial_index.posting_begins.assign(term_count + 1, 0);
+    
+    for (const auto& [term_id, term_frequency] : partial_index.term_frequencies) {
+        ++partial_index.posting_begins[term_id + 1];
+    }
+    
+    std::partial_sum(partial_index.posting_begins.begin(), partial_index.posting_begins.end(), partial_index.posting_begins.begin());
+    
+    std::vector<size_t> positions(partial_index.posting_begins.begin(), partial_index.posting_begins.end() - 1);
+    partial_index.posting_document_offsets.resize(posting_count);
+    partial_index.posting_term_frequencies.resize(posting_count);
+    
+    size_t document_begin = 0;
+    
+    for (size_t document_offset = 0; document_offset < partial_index.document_ends.size(); ++document_offset) {
+        const size_t document_end = partial_index.document_ends[document_offset];
+        
+        for (size_t i = document_begin; i < document_end; ++i) {
+            const auto& [term_id, term_frequency] = partial_index.term_frequencies[i];
+            const size_t position = positions[term_id]++;
+            
+            partial_index.posting_document_offsets[position] = static_cast<int>(document_offset);
+            partial_index.posting_term_frequencies[position] = term_frequency;
+        }
+        
+        document_begin = document_end;
+    }
+    
+    return partial_index;
+} // BuildPartialIndex
+
+void SearchServer::RenumberPartialIndex(PartialIndex& partial_index) {
+    size_t document_begin = 0;
+    
+    for (const size_t document_end : partial_index.document_ends) {
+        const auto begin = partial_index.term_frequencies.begin() + document_begin;
+        const auto end = partial_index.term_frequencies.begin() + document_end;
+        
+        for (auto term_frequency = begin; term_frequency != end; ++term_frequency) {
+            term_frequency->first = partial_index.term_ids[term_frequency->first];
+        }
+        
+        std::sort(begin, end);
+        
+        document_begin = document_end;
+    }
+} // RenumberPartialIndex
+
+void SearchServer::AppendPartialIndex(const PartialIndex& partial_index, std::vector<NewDocument>::const_iterator documents) {
+    if (postings_.size() < terms_.GetTermCount()) {
+        postings_.resize(terms_.GetTermCount());
+        compressed_postings_.resize(terms_.GetTermCount());
+        document_frequencies_.resize(terms_.GetTermCount(), 0);
+        inverse_document_frequencies_.Resize(terms_.GetTermCount());
+    }
+    
+    InvalidateStatistics();
+    
+    const int first_document_index = static_cast<int>(documents_.size());
+    
+    // every term of the chunk is walked once, its postings go after the ones of earlier chunks
+    for (TermId chunk_term_id = 0; chunk_term_id < partial_index.term_ids.size(); ++chunk_term_id) {
+        const TermId term_id = partial_index.term_ids[chunk_term_id];
+        PostingList& postings = GetMutablePostings(term_id);
+        
+        const size_t posting_begin = partial_index.posting_begins[chunk_term_id];
+        const size_t posting_end = partial_index.posting_begins[chunk_term_id + 1];
+        
+        for (size_t i = posting_begin; i < posting_end; ++i) {
+            postings.Add(first_document_index + partial_index.posting_document_offsets[i], partial_index.posting_term_frequencies[i]);
+        }
+        
+        document_frequencies_[term_id] += posting_end - posting_begin;
+    }
+    
+    size_t document_begin = 0;
+    
+    for (const size_t document_end : partial_index.document_ends) {
+        const int document_index = static_cast<int>(documents_.size());
+        
+        document_ids_.insert(documents->id);
+        document_id_to_index_.emplace(documents->id, document_index);
+        documents_.Append(documents->id, ComputeAverageRating(documents->ratings), documents->status);
+        forward_index_.Add(partial_index.term_frequencies.data() + document_begin, document_end - document_begin);
+        
+        document_begin = document_end;
+        ++documents;
+    }
+    
+    deleted_documents_.Resize(documents_.size());
+} // AppendPartialIndex
+
+std::vector<std::pair<TermId, double>> SearchServer::CountTermFrequencies(const std::vector<TermId>& term_ids) {
+    const double inverse_word_count = 1.0 / static_cast<double>(term_ids.size());
+    
+    std::vector<std::pair<TermId, double>> term_frequencies;
+    
+    // equal terms are adjacent and are counted in one go
+    for (const TermId term_id : term_ids) {
+        if (term_frequencies.empty() || term_frequencies.back().first != term_id) {
+            term_frequencies.emplace_back(term_id, 0.0);
+        }
+        
+        term_frequencies.back().second += inverse_word_count;
+    }
+    
+    return term_frequencies;
+} // CountTermFrequencies
+
+void SearchServer::AppendDocument(int document_id, int rating, DocumentStatus status,
+                                  const std::vector<std::pair<TermId, double>>& term_frequencies) {
+    if (postings_.size() < terms_.GetTermCount()) {
+        postings_.resize(terms_.GetTermCount());
+        compressed_postings_.resize(terms_.GetTermCount());
+        document_frequencies_.resize(terms_.GetTermCount(), 0);
+        inverse_document_frequencies_.Resize(terms_.GetTermCount());
+    }
+    
+    InvalidateStatistics();
+    
+    // new documents get the largest index, so postings are only appended to
+    const int document_index = static_cast<int>(documents_.size());
+    
+    for (const auto& [term_id, term_frequency] : term_frequencies) {
+        GetMutablePostings(term_id).Add(document_index, term_frequency);
+        ++document_frequencies_[term_id];
     }
     
     document_ids_.insert(document_id);
     
-    document_id_to_document_data_.emplace(document_id, DocumentData{ComputeAverageRating(ratings), status, word_frequencies});
+    document_id_to_index_.emplace(document_id, document_index);
     
-    return true;
-} // AddDocument
+    documents_.Append(document_id, rating, status);
+    
+    forward_index_.Add(term_frequencies);
+    
+    deleted_documents_.Resize(documents_.size());
+} // AppendDocument
+
+void SearchServer::MergeFrom(const SearchServer& other, const DocumentBitmap* removed_documents) {
+    const DocumentFilter filter{nullptr, removed_documents};
+    
+    for (const int document_id : other.document_ids_) {
+        if (document_id_to_index_.count(document_id) > 0 && !filter.Rejects(other.document_id_to_index_.at(document_id))) {
+            throw std::invalid_argument("repeating ids are not allowed"s);
+        }
+    }
+    
+    // other's terms are interned on first use
+    constexpr TermId kNoTerm = std::numeric_limits<TermId>::max();
+    std::vector<TermId> other_to_term_id(other.terms_.GetTermCount(), kNoTerm);
+    
+    std::vector<std::pair<TermId, double>> term_frequencies;
+    
+    // other's documents go in index order, so postings are only appended to, removed ones are left behind
+    for (int other_document_index = 0; other_document_index < static_cast<int>(other.documents_.size()); ++other_document_index) {
+        if (other.deleted_documents_.Test(other_document_index) || filter.Rejects(other_document_index)) {
+            continue;
+        }
+        
+        const int other_document_id = other.documents_.GetId(other_document_index);
+        
+        term_frequencies.clear();
+        
+        other.forward_index_.ForEachTerm(other_document_index, [&](TermId other_term_id, double term_frequency) {
+            if (other_to_term_id[other_term_id] == kNoTerm) {
+                other_to_term_id[other_term_id] = terms_.Intern(other.terms_.GetTerm(other_term_id));
+            }
+            
+            term_frequencies.emplace_back(other_to_term_id[other_term_id], term_frequency);
+        });
+        
+        std::sort(term_frequencies.begin(), term_frequencies.end());
+        
+        AppendDocument(other_document_id, other.documents_.GetRating(other_document_index), other.documents_.GetStatus(other_document_index),
+                       term_frequencies);
+    }
+} // MergeFrom
 
 int SearchServer::GetDocumentCount() const {
-    return static_cast<int>(document_id_to_document_data_.size());
+    return static_cast<int>(document_id_to_index_.size());
 } // GetDocumentCount
 
+bool SearchServer::ContainsDocument(int document_id, const DocumentBitmap* removed_documents) const {
+    const auto document_index = document_id_to_index_.find(document_id);
+    
+    return document_index != document_id_to_index_.end() && !DocumentFilter{nullptr, removed_documents}.Rejects(document_index->second);
+}
+
+int SearchServer::GetDocumentFrequency(std::string_view word) const {
+    const std::optional<TermId> term_id = terms_.Find(word);
+    
+    return term_id ? static_cast<int>(GetDocumentFrequency(*term_id)) : 0;
+}
+
+CollectionStatistics SearchServer::GetCollectionStatistics(std::string_view raw_query, const DocumentBitmap* removed_documents) const {
+    QueryArena::Scope scope;
+    
+    Query query(scope.GetResource());
+    if (!ParseQuery(raw_query, query)) {
+        throw std::invalid_argument("invalid request");
+    }
+    
+    CollectionStatistics statistics;
+    statistics.document_count = GetDocumentCount();
+    
+    for (const TermId term_id : query.plus_terms) {
+        statistics.document_frequencies.emplace(terms_.GetTerm(term_id), static_cast<int>(GetDocumentFrequency(term_id)));
+    }
+    
+    if (removed_documents == nullptr) {
+        return statistics;
+    }
+    
+    // marked documents are few until the segment holding them is merged or rewritten
+    for (int document_index = 0; document_index < static_cast<int>(removed_documents->size()); ++document_index) {
+        if (!removed_documents->Test(document_index) || deleted_documents_.Test(document_index)) {
+            continue;
+        }
+        
+        --statistics.document_count;
+        
+        for (const TermId term_id : query.plus_terms) {
+            if (forward_index_.Contains(document_index, term_id)) {
+                --statistics.document_frequencies.find(terms_.GetTerm(term_id))->second;
+            }
+        }
+    }
+    
+    return statistics;
+} // GetCollectionStatistics
+
+CollectionStatistics& CollectionStatistics::operator+=(const CollectionStatistics& other) {
+    document_count += other.document_count;
+    
+    for (const auto& [word, document_frequency] : other.document_frequencies) {
+        document_frequencies[word] += document_frequency;
+    }
+    
+    return *this;
+}
+
 
 
-std::vector<Document> SearchServer::FindTopDocuments(const std::string& raw_query,
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query,
                                                      const DocumentStatus& desired_status) const {
-    const auto predicate = [desired_status](int , DocumentStatus document_status, int ) {
-        return document_status == desired_status;
+    return FindTopDocuments(SearchOptions{}, raw_query, desired_status);
+} // FindTopDocuments with status as a second argument
+
+std::vector<Document> SearchServer::FindTopDocuments(const SearchOptions& options, std::string_view raw_query,
+                                                     const DocumentStatus& desired_status) const {
+    // documents of other statuses are skipped while walking postings, so everything that reaches the predicate passes
+    const auto predicate = [](int , DocumentStatus , int ) {
+        return true;
     };
     
-    return FindTopDocuments(raw_query, predicate);
-} // FindTopDocuments with status as a second argument
+    return FindTopDocuments(options, raw_query, predicate,
+                            DocumentFilter{&documents_.GetStatusDocuments(desired_status), options.removed_documents});
+}
 
-std::tuple<std::vector<std::string>, DocumentStatus> SearchServer::MatchDocument(std::execution::parallel_policy, const std::string& raw_query, int document_id) const {
+std::tuple<std::vector<std::string>, DocumentStatus> SearchServer::MatchDocument(std::execution::parallel_policy, std::string_view raw_query, int document_id) const {
     return MatchDocument(raw_query, document_id, Policy::parallel);
 }
 
-std::tuple<std::vector<std::string>, DocumentStatus> SearchServer::MatchDocument(std::execution::sequenced_policy, const std::string& raw_query, int document_id) const {
+std::tuple<std::vector<std::string>, DocumentStatus> SearchServer::MatchDocument(std::execution::sequenced_policy, std::string_view raw_query, int document_id) const {
     return MatchDocument(raw_query, document_id, Policy::sequential);
 }
 
 std::tuple<std::vector<std::string>, DocumentStatus> SearchServer::MatchDocument(
-                                                                                 const std::string& raw_query, 
+                                                                                 std::string_view raw_query, 
                                                                                  int document_id,
                                                                                  Policy policy) const {
-     Query query;
-    if (!ParseQuery(raw_query, query)) {
+    QueryArena::Scope scope;
+    
+    Query query(scope.GetResource());
+    if (!ParseQuery(raw_query, query, policy)) {
         throw std::invalid_argument("invalid request");
     }
     
+    const int document_index = document_id_to_index_.at(document_id);
     std::vector<std::string> matched_words;
-    for (const std::string& word : query.plus_words) {
-        if (word_to_document_id_to_term_frequency_.count(word) == 0) {
-            continue;
-        }
-        
-        if (word_to_document_id_to_term_frequency_.at(word).count(document_id)) {
-            matched_words.push_back(word);
+    for (const TermId term_id : query.plus_terms) {
+        if (forward_index_.Contains(document_index, term_id)) {
+            matched_words.emplace_back(terms_.GetTerm(term_id));
         }
     }
     
-    for (const std::string& word : query.minus_words) {
-        if (word_to_document_id_to_term_frequency_.count(word) == 0) {
-            continue;
-        }
-        
-        if (word_to_document_id_to_term_frequency_.at(word).count(document_id)) {
+    for (const TermId term_id : query.minus_terms) {
+        if (forward_index_.Contains(document_index, term_id)) {
             matched_words.clear();
             break;
         }
     }
     
-    return std::tuple<std::vector<std::string>, DocumentStatus>{matched_words, document_id_to_document_data_.at(document_id).status};
-} // MatchDocument
-
-std::vector<std::string> SearchServer::SplitIntoWordsNoStop(const std::string& text) const {
-    std::vector<std::string> words;
-    for (const std::string& word : string_processing::SplitIntoWords(text)) {
-        if (!IsStopWord(word)) {
-            words.push_back(word);
-        }
-    }
+    // term ids follow the indexing order
+    std::sort(matched_words.begin(), matched_words.end());
     
-    return words;
-} // SplitIntoWordsNoStop
+    return std::tuple<std::vector<std::string>, DocumentStatus>{matched_words, documents_.GetStatus(document_index)};
+} // MatchDocument
 
 int SearchServer::ComputeAverageRating(const std::vector<int>& ratings) {
     int rating_sum = 0;
@@ -218,22 +547,19 @@ int SearchServer::ComputeAverageRating(const std::vector<int>& ratings) {
     return rating_sum / static_cast<int>(ratings.size());
 } // ComputeAverageRating
 
-bool SearchServer::IsStopWord(const std::string& word) const {
-    return stop_words_.count(word) > 0;
+bool SearchServer::IsStopWord(std::string_view word) const {
+    return stop_words_.Contains(word);
 } // IsStopWord
 
-[[nodiscard]] bool SearchServer::ParseQueryWord(std::string text, QueryWord& result) const {
-    result = {};
-
+[[nodiscard]] bool SearchServer::ParseQueryWord(std::string_view text, QueryWord& result) const {
     if (text.empty()) {
         return false;
     }
-    bool is_minus = false;
-    if (text[0] == '-') {
-        is_minus = true;
-        text = text.substr(1);
+    const bool is_minus = text[0] == '-';
+    if (is_minus) {
+        text.remove_prefix(1);
     }
-    if (text.empty() || text[0] == '-' || !IsValidWord(text)) {
+    if (text.empty() || text[0] == '-') {
         return false;
     }
 
@@ -241,102 +567,451 @@ bool SearchServer::IsStopWord(const std::string& word) const {
     return true;
 }
 
-[[nodiscard]] bool SearchServer::ParseQuery(const std::string& text, Query& result) const {
-
-    result = {};
-    for (const std::string& word : string_processing::SplitIntoWords(text)) {
+[[nodiscard]] bool SearchServer::ParseQuery(std::string_view text, Query& result, Policy policy) const {
+    QueryArena::Scope scope;
+    std::pmr::memory_resource* resource = scope.GetResource();
+    
+    // control bytes are found by the same scan
+    std::pmr::vector<std::string_view> words(resource);
+    if (!string_processing::SplitIntoValidWords(text, words)) {
+        return false;
+    }
+    
+    // a word of the query, or no query when the word is invalid
+    const auto transform_word_in_query = [this](std::string_view word, std::pmr::memory_resource* resource) {
+        std::optional<Query> query(std::in_place, resource);
+        
         QueryWord query_word;
         if (!ParseQueryWord(word, query_word)) {
-            return false;
+            query.reset();
+            return query;
+        }
+        
+        if (query_word.is_stop) {
+            return query;
+        }
+        
+        const std::optional<TermId> term_id = terms_.Find(query_word.data);
+        
+        if (!term_id) {
+            query->has_missing_plus_terms = !query_word.is_minus;
+        } else if (query_word.is_minus) {
+            query->minus_terms.push_back(*term_id);
+        } else {
+            query->plus_terms.push_back(*term_id);
         }
-        if (!query_word.is_stop) {
-            if (query_word.is_minus) {
-                result.minus_words.insert(query_word.data);
+        
+        return query;
+    };
+    
+    if (policy == Policy::parallel && words.size() >= kMinParallelQueryWordCount) {
+        // the arena belongs to this thread, parts built by others come from the heap
+        std::pmr::memory_resource* heap = std::pmr::new_delete_resource();
+        
+        const auto combine_queries = [](std::optional<Query> first, std::optional<Query> second) {
+            if (first && second) {
+                *first += std::move(*second);
+            } else {
+                first.reset();
             }
-            else {
-                result.plus_words.insert(query_word.data);
+            
+            return first;
+        };
+        
+        std::optional<Query> query = std::transform_reduce(
+            std::execution::par, words.begin(), words.end(), std::optional<Query>(std::in_place, heap), combine_queries,
+            [&transform_word_in_query, heap](std::string_view word) {
+                return transform_word_in_query(word, heap);
+            });
+        
+        if (!query) {
+            return false;
+        }
+        
+        result += std::move(*query);
+    } else {
+        for (const std::string_view word : words) {
+            std::optional<Query> query = transform_word_in_query(word, resource);
+            
+            if (!query) {
+                return false;
             }
+            
+            result += std::move(*query);
         }
     }
+    
+    result.Normalize();
+    
     return true;
+} // ParseQuery
+
+size_t SearchServer::GetDocumentFrequency(TermId term_id) const {
+    return document_frequencies_[term_id];
 }
 
-/*
-SearchServer::Query SearchServer::ParseQuery(const std::string& text, Policy policy) const {
-    auto words = string_processing::SplitIntoWords(text);
+size_t SearchServer::GetPostingCount(TermId term_id) const {
+    return postings_[term_id].size() + compressed_postings_[term_id].size();
+}
 
-    const auto transform_word_in_query = [&](const std::string& word){
-        auto query_word = ParseQueryWord(word);
+PostingList& SearchServer::GetMutablePostings(TermId term_id) {
+    if (!compressed_postings_[term_id].empty()) {
+        postings_[term_id] = compressed_postings_[term_id].Decode();
+        compressed_postings_[term_id] = {};
+    }
+    
+    return postings_[term_id];
+} // GetMutablePostings
 
-        Query query;
-        if (!query_word.is_stop) {
-            if (query_word.is_minus) {
-                query.minus_words.insert(query_word.data);
-            } else {
-                query.plus_words.insert(query_word.data);
-            }
+void SearchServer::CompressPostings(Policy policy, Quantization quantization) {
+    std::vector<TermId> term_ids(postings_.size());
+    std::iota(term_ids.begin(), term_ids.end(), TermId{0});
+    
+    const auto compress = [this, quantization](TermId term_id) {
+        if (postings_[term_id].empty()) {
+            return;
         }
-
-        return query;
+        
+        compressed_postings_[term_id] = CompressedPostingList(postings_[term_id], quantization);
+        postings_[term_id] = {};
     };
+    
+    if (policy == Policy::parallel) {
+        std::for_each(std::execution::par, term_ids.begin(), term_ids.end(), compress);
+    } else {
+        std::for_each(std::execution::seq, term_ids.begin(), term_ids.end(), compress);
+    }
+} // CompressPostings
 
-    const auto combine_queries = [](Query first, Query second){
-        return first += std::move(second);
-    };
+void SearchServer::MarkRemoved(int document_id, DocumentBitmap& removed_documents) const {
+    const auto document_index = document_id_to_index_.find(document_id);
+    
+    if (document_index == document_id_to_index_.end()) {
+        return;
+    }
+    
+    removed_documents.Resize(documents_.size());
+    removed_documents.Set(document_index->second);
+}
+
+void SearchServer::SetMaxDeletedRatio(double max_deleted_ratio) {
+    if (!(max_deleted_ratio >= 0.0 && max_deleted_ratio <= 1.0)) {
+        throw std::invalid_argument("deleted ratio must be between 0 and 1"s);
+    }
+    
+    max_deleted_ratio_ = max_deleted_ratio;
+}
+
+size_t SearchServer::GetDeletedDocumentCount() const {
+    return deleted_documents_.Count();
+}
 
+void SearchServer::CompactPostings(Policy policy) {
+    if (deleted_documents_.Count() == 0) {
+        return;
+    }
+    
+    // live documents move down over the removed ones in the same order, so postings stay sorted
+    std::vector<int> new_document_indexes(documents_.size(), -1);
+    int live_document_count = 0;
+    
+    for (size_t document_index = 0; document_index < documents_.size(); ++document_index) {
+        if (!deleted_documents_.Test(static_cast<int>(document_index))) {
+            new_document_indexes[document_index] = live_document_count++;
+        }
+    }
+    
+    std::vector<TermId> term_ids(postings_.size());
+    std::iota(term_ids.begin(), term_ids.end(), TermId{0});
+    
+    // compressed lists stay compressed with the same quantization
+    const auto compact = [this, &new_document_indexes](TermId term_id) {
+        if (compressed_postings_[term_id].empty()) {
+            postings_[term_id].Renumber(new_document_indexes);
+            return;
+        }
+        
+        PostingList postings = compressed_postings_[term_id].Decode();
+        postings.Renumber(new_document_indexes);
+        
+        compressed_postings_[term_id] = postings.empty()
+                                      ? CompressedPostingList()
+                                      : CompressedPostingList(postings, compressed_postings_[term_id].GetQuantization());
+    };
+    
     if (policy == Policy::parallel) {
-        return std::transform_reduce(std::execution::par, words.begin(), words.end(), Query{}, combine_queries, transform_word_in_query);
+        std::for_each(std::execution::par, term_ids.begin(), term_ids.end(), compact);
     } else {
-        return std::transform_reduce(std::execution::seq, words.begin(), words.end(), Query{}, combine_queries, transform_word_in_query);
+        std::for_each(std::execution::seq, term_ids.begin(), term_ids.end(), compact);
     }
-} // ParseQuery
-*/
+    
+    documents_.Compact(deleted_documents_);
+    forward_index_.Compact(deleted_documents_);
+    
+    for (auto& [document_id, document_index] : document_id_to_index_) {
+        document_index = new_document_indexes[static_cast<size_t>(document_index)];
+    }
+    
+    deleted_documents_ = DocumentBitmap();
+    deleted_documents_.Resize(documents_.size());
+    
+    // cached bitmaps are indexed the old way
+    exclusion_bitmaps_.Clear();
+} // CompactPostings
 
-// Existence required
-double SearchServer::ComputeWordInverseDocumentFrequency(const std::string& word) const {
-    assert(word_to_document_id_to_term_frequency_.count(word) != 0);
+void SearchServer::FreezeStatistics() {
+    is_statistics_frozen_ = true;
+    
+    RefreshStatistics();
+}
+
+void SearchServer::RefreshStatistics() {
+    ++statistics_generation_;
+    
+    for (TermId term_id = 0; term_id < document_frequencies_.size(); ++term_id) {
+        if (document_frequencies_[term_id] > 0) {
+            ComputeWordInverseDocumentFrequency(term_id, nullptr);
+        }
+    }
+} // RefreshStatistics
+
+void SearchServer::UnfreezeStatistics() {
+    is_statistics_frozen_ = false;
     
-    const size_t number_of_documents_constains_word = word_to_document_id_to_term_frequency_.at(word).size();
+    InvalidateStatistics();
+}
+
+void SearchServer::InvalidateStatistics() {
+    if (!is_statistics_frozen_) {
+        ++statistics_generation_;
+    }
+}
+
+// Existence required
+double SearchServer::ComputeWordInverseDocumentFrequency(TermId term_id, const CollectionStatistics* collection_statistics) const {
+    assert(term_id < postings_.size());
     
-    assert(number_of_documents_constains_word != 0);
+    if (collection_statistics != nullptr) {
+        const auto word_statistics = collection_statistics->document_frequencies.find(terms_.GetTerm(term_id));
+        
+        assert(word_statistics != collection_statistics->document_frequencies.end());
+        
+        const int number_of_documents_constains_word = word_statistics->second;
+        
+        return std::log(static_cast<double>(collection_statistics->document_count) / number_of_documents_constains_word);
+    }
     
-    return std::log(static_cast<double>(GetDocumentCount()) / number_of_documents_constains_word);
+    return inverse_document_frequencies_.Get(term_id, statistics_generation_, [this, term_id] {
+        const size_t number_of_documents_constains_word = GetDocumentFrequency(term_id);
+        
+        assert(number_of_documents_constains_word != 0);
+        
+        return std::log(static_cast<double>(GetDocumentCount()) / number_of_documents_constains_word);
+    });
 } // ComputeWordInverseDocumentFrequency
 
-std::vector<Document> SearchServer::FindAllDocuments(const Query& query) const {
-    std::map<int, double> document_id_to_relevance;
+std::shared_ptr<const DocumentBitmap> SearchServer::GetExclusionBitmap(TermId term_id) const {
+    if (GetPostingCount(term_id) < kMinCachedExclusionPostingCount) {
+        return nullptr;
+    }
+    
+    return exclusion_bitmaps_.Get(term_id, documents_.size(), [this, term_id](DocumentBitmap& bitmap, int first_document_index) {
+        PostingCursor cursor(postings_[term_id], compressed_postings_[term_id]);
+        
+        for (cursor.NextGreaterOrEqual(first_document_index); cursor.GetDocumentId() != PostingCursor::kEndDocumentId; cursor.Next()) {
+            bitmap.Set(cursor.GetDocumentId());
+        }
+    });
+} // GetExclusionBitmap
+
+void SearchServer::CreateCursors(const Query& query, const CollectionStatistics* collection_statistics,
+                                 std::pmr::deque<TermCursor>& plus_cursors, Exclusions& exclusions,
+                                 EvaluationStatistics& statistics) const {
+    for (const TermId term_id : query.plus_terms) {
+        if (GetDocumentFrequency(term_id) > 0) {
+            plus_cursors.emplace_back(postings_[term_id], compressed_postings_[term_id],
+                                      ComputeWordInverseDocumentFrequency(term_id, collection_statistics));
+            
+            statistics.postings_total += GetPostingCount(term_id);
+        }
+    }
     
-    for (const std::string& word : query.plus_words) {
-        if (word_to_document_id_to_term_frequency_.count(word) == 0) {
+    for (const TermId term_id : query.minus_terms) {
+        if (GetDocumentFrequency(term_id) == 0) {
             continue;
         }
         
-        const double inverse_document_frequency = ComputeWordInverseDocumentFrequency(word);
+        if (auto bitmap = GetExclusionBitmap(term_id)) {
+            exclusions.bitmaps.push_back(std::move(bitmap));
+        } else {
+            exclusions.cursors.emplace_back(postings_[term_id], compressed_postings_[term_id]);
+        }
+    }
+} // CreateCursors
+
+bool SearchServer::IsExcluded(Exclusions& exclusions, int document_index) {
+    if (exclusions.filter.Rejects(document_index)) {
+        return true;
+    }
+    
+    for (const auto& bitmap : exclusions.bitmaps) {
+        if (bitmap->Test(document_index)) {
+            return true;
+        }
+    }
+    
+    for (PostingCursor& minus_cursor : exclusions.cursors) {
+        minus_cursor.NextGreaterOrEqual(document_index);
         
-        for (const auto &[document_id, term_frequency] : word_to_document_id_to_term_frequency_.at(word)) {
-            document_id_to_relevance[document_id] += term_frequency * inverse_document_frequency;
+        if (minus_cursor.GetDocumentId() == document_index) {
+            return true;
         }
     }
     
-    for (const std::string& word : query.minus_words) {
-        if (word_to_document_id_to_term_frequency_.count(word) == 0) {
+    return false;
+} // IsExcluded
+
+void SearchServer::FindAllDocuments(const Query& query, const CollectionStatistics* collection_statistics,
+                                    const DocumentFilter& filter, RelevanceAccumulator& accumulator,
+                                    EvaluationStatistics& statistics) const {
+    accumulator.Reset(documents_.size());
+    
+    QueryArena::Scope scope;
+    
+    // excluded before scoring, so their documents are never accumulated
+    std::pmr::vector<std::shared_ptr<const DocumentBitmap>> exclusion_bitmaps(scope.GetResource());
+    
+    for (const TermId term_id : query.minus_terms) {
+        if (auto bitmap = GetExclusionBitmap(term_id)) {
+            exclusion_bitmaps.push_back(std::move(bitmap));
             continue;
         }
         
-        for (const auto &[document_id, _] : word_to_document_id_to_term_frequency_.at(word)) {
-            document_id_to_relevance.erase(document_id);
-        }
+        ForEachPosting(term_id, [&accumulator](int document_index, double) {
+            accumulator.Exclude(document_index);
+        });
     }
     
-    std::vector<Document> matched_documents;
-    for (const auto &[document_id, relevance] : document_id_to_relevance) {
-        matched_documents.push_back({ document_id, relevance,
-            document_id_to_document_data_.at(document_id).rating});
+    const auto is_excluded = [&exclusion_bitmaps, &filter](int document_index) {
+        if (filter.Rejects(document_index)) {
+            return true;
+        }
+        
+        return std::any_of(exclusion_bitmaps.begin(), exclusion_bitmaps.end(), [document_index](const auto& bitmap) {
+            return bitmap->Test(document_index);
+        });
+    };
+    
+    for (const TermId term_id : query.plus_terms) {
+        if (GetDocumentFrequency(term_id) == 0) {
+            continue;
+        }
+        
+        const double inverse_document_frequency = ComputeWordInverseDocumentFrequency(term_id, collection_statistics);
+        
+        statistics.postings_total += GetPostingCount(term_id);
+        statistics.postings_scored += GetPostingCount(term_id);
+        
+        ForEachPosting(term_id, [&accumulator, &is_excluded, inverse_document_frequency](int document_index, double term_frequency) {
+            if (!is_excluded(document_index)) {
+                accumulator.Add(document_index, term_frequency * inverse_document_frequency);
+            }
+        });
     }
     
-    return matched_documents;
+    statistics.documents_scored += accumulator.GetTouchedCount();
 } // FindAllDocuments
 
+std::pmr::vector<int> SearchServer::IntersectPostings(const Query& query, std::pmr::memory_resource* resource) const {
+    std::pmr::vector<TermId> term_ids(query.plus_terms.begin(), query.plus_terms.end(), resource);
+    
+    // the shortest list bounds the result, the others only narrow it down
+    std::sort(term_ids.begin(), term_ids.end(), [this](TermId left, TermId right) {
+        return GetPostingCount(left) < GetPostingCount(right);
+    });
+    
+    std::pmr::vector<int> decoded_document_ids(resource);
+    
+    const auto get_document_ids = [this, &decoded_document_ids](TermId term_id) -> const std::pmr::vector<int>& {
+        decoded_document_ids.clear();
+        
+        ForEachPosting(term_id, [&decoded_document_ids](int document_index, double) {
+            decoded_document_ids.push_back(document_index);
+        });
+        
+        return decoded_document_ids;
+    };
+    
+    std::pmr::vector<int> document_indexes(resource);
+    
+    if (compressed_postings_[term_ids[0]].empty()) {
+        const std::vector<int>& document_ids = postings_[term_ids[0]].GetDocumentIds();
+        document_indexes.assign(document_ids.begin(), document_ids.end());
+    } else {
+        document_indexes = get_document_ids(term_ids[0]);
+    }
+    
+    for (size_t i = 1; i < term_ids.size() && !document_indexes.empty(); ++i) {
+        const TermId term_id = term_ids[i];
+        
+        // plain lists are intersected where they are, compressed ones are decoded first
+        const int* document_ids = nullptr;
+        size_t document_count = 0;
+        
+        if (compressed_postings_[term_id].empty()) {
+            document_ids = postings_[term_id].GetDocumentIds().data();
+            document_count = postings_[term_id].size();
+        } else {
+            document_ids = get_document_ids(term_id).data();
+            document_count = decoded_document_ids.size();
+        }
+        
+        document_indexes.resize(IntersectDocumentIds(document_indexes.data(), document_indexes.size(),
+                                                     document_ids, document_count, document_indexes.data()));
+    }
+    
+    return document_indexes;
+} // IntersectPostings
+
+RelevanceAccumulator& SearchServer::GetThreadAccumulator() {
+    thread_local RelevanceAccumulator accumulator;
+    
+    return accumulator;
+}
+
+MemoryReport SearchServer::GetMemoryReport() const {
+    MemoryReport report;
+    
+    report.term_count = terms_.GetTermCount();
+    report.term_dictionary_bytes = terms_.GetMemoryUsage();
+    report.forward_index_bytes = forward_index_.GetMemoryUsage();
+    report.document_column_bytes = documents_.GetMemoryUsage();
+    report.exclusion_bitmap_bytes = exclusion_bitmaps_.GetMemoryUsage();
+    
+    for (TermId term_id = 0; term_id < postings_.size(); ++term_id) {
+        report.posting_bytes += postings_[term_id].GetMemoryUsage();
+        report.compressed_posting_bytes += compressed_postings_[term_id].GetMemoryUsage();
+        
+        const size_t document_count = GetPostingCount(term_id);
+        
+        if (document_count == 0) {
+            continue;
+        }
+        
+        const std::string_view term = terms_.GetTerm(term_id);
+        
+        // short strings fit into the small string buffer, longer ones get their own heap block
+        const size_t string_bytes = sizeof(std::string) + (term.size() >= sizeof(std::string) / 2 ? term.size() + 1 : 0);
+        
+        // one key in the inverted index and one in every forward map
+        report.string_key_bytes += string_bytes * (document_count + 1);
+        report.term_id_bytes += sizeof(TermId) * (document_count + 1);
+        report.posting_count += document_count;
+    }
+    
+    return report;
+} // GetMemoryReport
+
 // bool SearchServer::IsValidWord(const std::string& word) {
 //     // A valid word must not contain special characters
 //     return none_of(word.begin(), word.end(), [](char c) {
@@ -366,7 +1041,7 @@ void AddDocument(SearchServer& search_server, int document_id, const std::string
     }
 }
 
-void FindTopDocuments(const SearchServer& search_server, const std::string& raw_query) {
+void FindTopDocuments(const SearchServer& search_server, std::string_view raw_query) {
     LOG_DURATION("Operation time");
     
     std::cout << "Результаты поиска по запросу: "s << raw_query << std::endl;
@@ -7,13 +7,89 @@
 #include <map>
 #include <algorithm>
 #include <execution>
+#include <deque>
+#include <limits>
+#include <memory_resource>
 
 #include "document.h"
+#include "document_bitmap.h"
+#include "document_columns.h"
+#include "exclusion_cache.h"
+#include "forward_index.h"
+#include "idf_cache.h"
+#include "memory_report.h"
+#include "posting_list.h"
+#include "compressed_posting_list.h"
+#include "posting_cursor.h"
+#include "posting_intersection.h"
+#include "query_arena.h"
+#include "small_vector.h"
+#include "stop_word_filter.h"
+#include "top_documents.h"
+#include "relevance_accumulator.h"
+#include "term_dictionary.h"
 
 enum class Policy {
     parallel, sequential
 };
 
+enum class Evaluation {
+    exhaustive, block_max_wand, max_score
+};
+
+// any plus word is enough for a document to match, or every one is required
+enum class Matching {
+    any, all
+};
+
+struct EvaluationStatistics {
+    size_t postings_total = 0;
+    size_t postings_scored = 0;
+    size_t documents_scored = 0;
+    
+    size_t GetPostingsSkipped() const {
+        return postings_total - postings_scored;
+    }
+};
+
+// Document counts of a collection a server is a part of, such as a set of shards
+struct CollectionStatistics {
+    int document_count = 0;
+    std::map<std::string, int, std::less<>> document_frequencies;
+    
+    CollectionStatistics& operator+=(const CollectionStatistics& other);
+};
+
+struct SearchOptions {
+    Evaluation evaluation = Evaluation::exhaustive;
+    
+    // Matching::all intersects the posting lists and ignores the evaluation
+    Matching matching = Matching::any;
+    
+    int max_result_document_count = 5;
+    
+    // filled in when set
+    EvaluationStatistics* statistics = nullptr;
+    
+    // inverse document frequencies are computed from these when set, they must cover every plus word
+    const CollectionStatistics* collection_statistics = nullptr;
+    
+    // only long machine-generated queries benefit from parallel parsing
+    Policy parse_policy = Policy::sequential;
+    
+    // documents marked by SearchServer::MarkRemoved, skipped like removed ones;
+    // collection statistics should be taken with the same bitmap
+    const DocumentBitmap* removed_documents = nullptr;
+};
+
+// one document of an AddDocuments batch
+struct NewDocument {
+    int id = 0;
+    std::string text;
+    DocumentStatus status = DocumentStatus::ACTUAL;
+    std::vector<int> ratings;
+};
+
 class SearchServer {
 public:
     SearchServer() = default;
@@ -28,84 +104,282 @@ public:
 public:
     void SetStopWords(std::string_view text);
     
+    // no-op for unknown documents
+    void SetDocumentStatus(int document_id, DocumentStatus status);
+    
     bool AddDocument(int document_id, const std::string& document,
                      DocumentStatus status, const std::vector<int>& ratings);
     
+    // Tokenizes the batch in chunks, in parallel with Policy::parallel, and appends the documents in
+    // batch order. The whole batch is validated first, nothing is added if any document is rejected.
+    void AddDocuments(const std::vector<NewDocument>& documents, Policy policy = Policy::sequential);
+    
+    // Appends the live documents of another server with their exact term frequencies, leaving out
+    // those marked in removed_documents. Both servers must use the same stop words, repeating ids are not allowed.
+    void MergeFrom(const SearchServer& other, const DocumentBitmap* removed_documents = nullptr);
+    
     int GetDocumentCount() const;
     
+    // documents marked in removed_documents by MarkRemoved are not contained
+    bool ContainsDocument(int document_id, const DocumentBitmap* removed_documents = nullptr) const;
+    
+    int GetDocumentFrequency(std::string_view word) const;
+    
+    // document count and frequencies of the query plus words, not counting documents marked in removed_documents
+    CollectionStatistics GetCollectionStatistics(std::string_view raw_query, const DocumentBitmap* removed_documents = nullptr) const;
+    
     template<typename Predicate>
-    std::vector<Document> FindTopDocuments(const std::string& raw_query, Predicate predicate) const;
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, Predicate predicate) const;
     
-    std::vector<Document> FindTopDocuments(const std::string& raw_query,
+    std::vector<Document> FindTopDocuments(std::string_view raw_query,
                                            const DocumentStatus& desired_status = DocumentStatus::ACTUAL) const;
     
-    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(const std::string& raw_query, int document_id, Policy policy = Policy::sequential) const;
+    template<typename Predicate>
+    std::vector<Document> FindTopDocuments(const SearchOptions& options, std::string_view raw_query, Predicate predicate) const;
+    
+    std::vector<Document> FindTopDocuments(const SearchOptions& options, std::string_view raw_query,
+                                           const DocumentStatus& desired_status = DocumentStatus::ACTUAL) const;
+    
+    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(std::string_view raw_query, int document_id, Policy policy = Policy::sequential) const;
 
-    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(std::execution::parallel_policy, const std::string& raw_query, int document_id) const;
+    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(std::execution::parallel_policy, std::string_view raw_query, int document_id) const;
 
-    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(std::execution::sequenced_policy, const std::string& raw_query, int document_id) const;
+    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(std::execution::sequenced_policy, std::string_view raw_query, int document_id) const;
     
     std::set<int>::const_iterator begin() const;
     
     std::set<int>::const_iterator end() const;
     
-    const std::map<std::string, double>& GetWordFrequencies(int document_id) const;
+    // empty for unknown documents, the view is valid until the next change of the server
+    WordFrequencies GetWordFrequencies(int document_id) const;
     
+    // Removal only marks the document as deleted. Its postings are purged in bulk once deleted documents
+    // make up more than the maximal deleted ratio of the indexed ones, the policy is used by that purge.
+    // The purge runs inline, so the removal that crosses the ratio costs as much as CompactPostings: a pass
+    // over every posting, the columns and the forward index. Callers that cannot afford that on a removal
+    // set the ratio to 1 and call CompactPostings themselves when it suits them.
     void RemoveDocument(int document_id, Policy policy = Policy::sequential);
 
     void RemoveDocument(std::execution::sequenced_policy p, const int document_id);
 
     void RemoveDocument(std::execution::parallel_policy p, int document_id);
+
+    // Removal from a server shared read-only, such as a frozen segment: the document is only marked
+    // in removed_documents, which queries honour through SearchOptions::removed_documents. No-op for unknown documents.
+    void MarkRemoved(int document_id, DocumentBitmap& removed_documents) const;
+    
+    // 0 purges postings on every removal, 1 only on explicit CompactPostings calls
+    void SetMaxDeletedRatio(double max_deleted_ratio);
+    
+    // removed documents whose postings are not purged yet
+    size_t GetDeletedDocumentCount() const;
+    
+    // Purges postings of removed documents and renumbers the live ones to reclaim their slots.
+    // Bitmaps filled by MarkRemoved before refer to the old numbering.
+    void CompactPostings(Policy policy = Policy::sequential);
+    
+    // Pins inverse document frequencies to the current document counts, later writes do not change them
+    // until RefreshStatistics. Terms first indexed after that get frequencies of the moment they are first queried.
+    void FreezeStatistics();
+    
+    // recomputes every inverse document frequency now instead of on first use
+    void RefreshStatistics();
+    
+    void UnfreezeStatistics();
+    
+    MemoryReport GetMemoryReport() const;
+    
+    // Moves every posting list into the compressed format. Term frequencies stored there are quantized,
+    // lists touched by later writes are decompressed and stay plain until the next call.
+    void CompressPostings(Policy policy = Policy::sequential, Quantization quantization = Quantization::uint16);
     
 private:
-    struct DocumentData {
-        int rating = 0;
-        DocumentStatus status = DocumentStatus::ACTUAL;
-        std::map<std::string, double> word_frequencies;
-    };
+    // real queries are shorter
+    static constexpr size_t kInlineQueryTermCount = 16;
+    
+    // candidates are filtered by predicates this many at a time
+    static constexpr size_t kPredicateBatchSize = 64;
     
+    // parallel parsing does not pay off for shorter queries
+    static constexpr size_t kMinParallelQueryWordCount = 256;
+    
+    // shorter minus postings are cheaper to walk than a bitmap is to build and keep
+    static constexpr size_t kMinCachedExclusionPostingCount = 1024;
+    
+    // lives in a query arena, words missing from the dictionary are left out
     struct Query {
-        std::set<std::string> plus_words;
-        std::set<std::string> minus_words;
+        explicit Query(std::pmr::memory_resource* resource)
+            : plus_terms(resource), minus_terms(resource) {}
+        
+        SmallVector<TermId, kInlineQueryTermCount> plus_terms;
+        SmallVector<TermId, kInlineQueryTermCount> minus_terms;
+        
+        // no document contains every plus word then
+        bool has_missing_plus_terms = false;
 
+        // appends, Normalize restores the order
         Query& operator+=(Query&& other) {
-            for (const auto& other_plus_word : other.plus_words) {
-                plus_words.insert(std::move(other_plus_word));
+            for (const TermId term_id : other.plus_terms) {
+                plus_terms.push_back(term_id);
             }
 
-            for (const auto& other_minus_word : other.minus_words) {
-                minus_words.insert(std::move(other_minus_word));
+            for (const TermId term_id : other.minus_terms) {
+                minus_terms.push_back(term_id);
             }
+            
+            has_missing_plus_terms = has_missing_plus_terms || other.has_missing_plus_terms;
 
             return *this;
         }
+        
+        void Normalize() {
+            plus_terms.SortAndDeduplicate();
+            minus_terms.SortAndDeduplicate();
+        }
+    };
+    
+    // Index of a batch chunk built by one thread, terms are numbered by a dictionary of the chunk
+    // until term_ids maps them to the server ones. Postings are packed by chunk term, and a posting
+    // refers to a document by its offset in the chunk.
+    struct PartialIndex {
+        TermDictionary terms;
+        std::vector<TermId> term_ids;
+        
+        // postings of chunk term i are in [posting_begins[i], posting_begins[i + 1])
+        std::vector<size_t> posting_begins;
+        std::vector<int> posting_document_offsets;
+        std::vector<double> posting_term_frequencies;
+        
+        // forward index slices of the documents back to back
+        std::vector<std::pair<TermId, double>> term_frequencies;
+        std::vector<size_t> document_ends;
+        
+        // indexing stops at the first text with control bytes
+        bool is_valid = true;
     };
     
     struct QueryWord {
-        std::string data;
+        std::string_view data;
         bool is_minus = false;
         bool is_stop = false;
     };
     
-private:
-    static constexpr int kMaxResultDocumentCount = 5;
-    static constexpr double kAccuracy = 1e-6;
+    // documents a query skips besides removed ones, null bitmaps do not filter
+    struct DocumentFilter {
+        // documents of the status the query asks for
+        const DocumentBitmap* status_documents = nullptr;
+        // documents removed from a server shared read-only
+        const DocumentBitmap* removed_documents = nullptr;
+        
+        bool Rejects(int document_index) const {
+            return (status_documents != nullptr && !status_documents->Test(document_index))
+                || (removed_documents != nullptr && static_cast<size_t>(document_index) < removed_documents->size()
+                    && removed_documents->Test(document_index));
+        }
+    };
     
-private:
-    std::vector<std::string> SplitIntoWordsNoStop(const std::string& text) const;
+    // minus words of a query, those with cached bitmaps are not walked
+    struct Exclusions {
+        explicit Exclusions(std::pmr::memory_resource* resource)
+            : cursors(resource), bitmaps(resource) {}
+        
+        std::pmr::deque<PostingCursor> cursors;
+        std::pmr::vector<std::shared_ptr<const DocumentBitmap>> bitmaps;
+        DocumentFilter filter;
+    };
+    
+    struct TermCursor {
+        TermCursor(const PostingList& postings, const CompressedPostingList& compressed_postings, double inverse_document_frequency)
+            : cursor(postings, compressed_postings), inverse_document_frequency(inverse_document_frequency),
+              max_score(cursor.GetMaxTermFrequency() * inverse_document_frequency) {}
+        
+        PostingCursor cursor;
+        double inverse_document_frequency;
+        double max_score;
+    };
     
+private:
     static int ComputeAverageRating(const std::vector<int>& ratings);
     
-    bool IsStopWord(const std::string& word) const;
+    bool IsStopWord(std::string_view word) const;
+    
+    // term ids must be sorted, equal ones are counted into one term frequency
+    static std::vector<std::pair<TermId, double>> CountTermFrequencies(const std::vector<TermId>& term_ids);
+    
+    PartialIndex BuildPartialIndex(std::vector<NewDocument>::const_iterator begin,
+                                   std::vector<NewDocument>::const_iterator end) const;
+    
+    // the chunk terms must be interned, forward index slices are renumbered and sorted by term id
+    static void RenumberPartialIndex(PartialIndex& partial_index);
+    
+    // chunks are appended in batch order, documents are the ones of the chunk
+    void AppendPartialIndex(const PartialIndex& partial_index, std::vector<NewDocument>::const_iterator documents);
+    
+    [[nodiscard]] bool ParseQueryWord(std::string_view text, QueryWord& result) const;
     
-    [[nodiscard]] bool ParseQueryWord(std::string text, QueryWord& result) const;
+    // Result must be empty, it gets sorted unique term ids. Policy::parallel splits
+    // the words between threads when there are at least kMinParallelQueryWordCount of them.
+    [[nodiscard]] bool ParseQuery(std::string_view text, Query& result, Policy policy = Policy::sequential) const;
     
-    [[nodiscard]] bool ParseQuery(const std::string& text, Query& result) const;
+    // live documents containing the term
+    size_t GetDocumentFrequency(TermId term_id) const;
     
-    // Existence required
-    double ComputeWordInverseDocumentFrequency(const std::string& word) const;
+    // including postings of removed documents
+    size_t GetPostingCount(TermId term_id) const;
     
-    std::vector<Document> FindAllDocuments(const Query& query) const;
+    PostingList& GetMutablePostings(TermId term_id);
+    
+    // term frequencies sorted by term id
+    void AppendDocument(int document_id, int rating, DocumentStatus status,
+                        const std::vector<std::pair<TermId, double>>& term_frequencies);
+    
+    template <typename Function>
+    void ForEachPosting(TermId term_id, Function function) const;
+    
+    // Existence required. Cached unless computed from the collection statistics.
+    double ComputeWordInverseDocumentFrequency(TermId term_id, const CollectionStatistics* collection_statistics) const;
+    
+    // every write that changes document counts goes through here
+    void InvalidateStatistics();
+    
+    // documents the filter rejects are skipped before scoring, the predicate never sees them
+    template<typename Predicate>
+    std::vector<Document> FindTopDocuments(const SearchOptions& options, std::string_view raw_query, Predicate predicate,
+                                           const DocumentFilter& filter) const;
+    
+    // accumulates relevance of every document matching the query
+    void FindAllDocuments(const Query& query, const CollectionStatistics* collection_statistics, const DocumentFilter& filter,
+                          RelevanceAccumulator& accumulator, EvaluationStatistics& statistics) const;
+    
+    static RelevanceAccumulator& GetThreadAccumulator();
+    
+    // a bitmap of every document containing the term, only for frequent minus words with long postings
+    std::shared_ptr<const DocumentBitmap> GetExclusionBitmap(TermId term_id) const;
+    
+    // cursors are not movable, hence deques
+    void CreateCursors(const Query& query, const CollectionStatistics* collection_statistics, std::pmr::deque<TermCursor>& plus_cursors,
+                       Exclusions& exclusions, EvaluationStatistics& statistics) const;
+    
+    // minus cursors only move forward, so documents must be checked in increasing index order
+    static bool IsExcluded(Exclusions& exclusions, int document_index);
+    
+    // document-at-a-time, skips postings whose block maxima cannot beat the current top
+    template<typename Predicate>
+    void FindTopDocumentsBlockMaxWand(const Query& query, const CollectionStatistics* collection_statistics, Predicate predicate,
+                                      const DocumentFilter& filter, TopDocuments& top_documents, EvaluationStatistics& statistics) const;
+    
+    // document-at-a-time, candidates come only from terms that could beat the current top on their own
+    template<typename Predicate>
+    void FindTopDocumentsMaxScore(const Query& query, const CollectionStatistics* collection_statistics, Predicate predicate,
+                                  const DocumentFilter& filter, TopDocuments& top_documents, EvaluationStatistics& statistics) const;
+    
+    // sorted indexes of documents in every plus term posting list, removed ones included
+    std::pmr::vector<int> IntersectPostings(const Query& query, std::pmr::memory_resource* resource) const;
+    
+    // only documents containing every plus word are scored
+    template<typename Predicate>
+    void FindTopDocumentsConjunctive(const Query& query, const CollectionStatistics* collection_statistics, Predicate predicate,
+                                     const DocumentFilter& filter, TopDocuments& top_documents, EvaluationStatistics& statistics) const;
     
     template<typename StringType>
     static bool IsValidWord(const StringType& word) {
@@ -115,11 +389,35 @@ private:
     }
     
 private:
-    std::set<std::string> stop_words_;
+    StopWordFilter stop_words_;
+    
+    TermDictionary terms_;
+    
+    // indexed by TermId, a term keeps its postings in exactly one of these
+    std::vector<PostingList> postings_;
+    std::vector<CompressedPostingList> compressed_postings_;
+    
+    // indexed by TermId, postings of removed documents are not counted
+    std::vector<size_t> document_frequencies_;
     
-    std::map<std::string, std::map<int, double>> word_to_document_id_to_term_frequency_;
+    // documents removed since the last compaction, their postings are skipped by queries
+    DocumentBitmap deleted_documents_;
+    double max_deleted_ratio_ = 0.2;
     
-    std::map<int, DocumentData> document_id_to_document_data_;
+    // indexed by TermId, entries stamped with an older generation are stale
+    IdfCache inverse_document_frequencies_;
+    
+    ExclusionCache exclusion_bitmaps_;
+    std::uint64_t statistics_generation_ = 1;
+    bool is_statistics_frozen_ = false;
+    
+    // postings refer to documents by their dense index in documents_, removed documents keep their slots until compaction
+    DocumentColumns documents_;
+    
+    // terms of every document by dense index, removed documents have none until compaction
+    ForwardIndex forward_index_;
+    
+    std::map<int, int> document_id_to_index_;
     
     std::set<int> document_ids_;
 };
@@ -133,44 +431,392 @@ SearchServer::SearchServer(const StringCollection& stop_words) {
             throw std::invalid_argument("stop word contains unaccaptable symbol"s);
         }
         
-        stop_words_.insert(stop_word);
+        stop_words_.Insert(stop_word);
     }
 }
 
+template <typename Function>
+void SearchServer::ForEachPosting(TermId term_id, Function function) const {
+    const CompressedPostingList& compressed_postings = compressed_postings_[term_id];
+    
+    if (compressed_postings.empty()) {
+        const std::vector<int>& document_ids = postings_[term_id].GetDocumentIds();
+        const std::vector<double>& term_frequencies = postings_[term_id].GetTermFrequencies();
+        
+        for (size_t i = 0; i < document_ids.size(); ++i) {
+            function(document_ids[i], term_frequencies[i]);
+        }
+        
+        return;
+    }
+    
+    int document_ids[CompressedPostingList::kBlockSize];
+    double term_frequencies[CompressedPostingList::kBlockSize];
+    
+    for (size_t block_index = 0; block_index < compressed_postings.GetBlockCount(); ++block_index) {
+        const size_t block_size = compressed_postings.DecodeBlock(block_index, document_ids, term_frequencies);
+        
+        for (size_t i = 0; i < block_size; ++i) {
+            function(document_ids[i], term_frequencies[i]);
+        }
+    }
+} // ForEachPosting
+
+template<typename Predicate>
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, Predicate predicate) const {
+    return FindTopDocuments(SearchOptions{}, raw_query, predicate);
+}
+
+template<typename Predicate>
+std::vector<Document> SearchServer::FindTopDocuments(const SearchOptions& options, std::string_view raw_query,
+                                                     Predicate predicate) const {
+    return FindTopDocuments(options, raw_query, predicate, DocumentFilter{nullptr, options.removed_documents});
+}
+
 template<typename Predicate>
-std::vector<Document> SearchServer::FindTopDocuments(const std::string& raw_query, Predicate predicate) const {
-     Query query;
-    if (!ParseQuery(raw_query, query)) {
+std::vector<Document> SearchServer::FindTopDocuments(const SearchOptions& options, std::string_view raw_query,
+                                                     Predicate predicate, const DocumentFilter& filter) const {
+    // query temporaries go away with the scope, only the result is allocated on the heap
+    QueryArena::Scope scope;
+    
+    Query query(scope.GetResource());
+    if (!ParseQuery(raw_query, query, options.parse_policy)) {
         throw std::invalid_argument("invalid request");
     };
     
-    std::vector<Document> matched_documents = FindAllDocuments(query);
+    if (options.max_result_document_count < 0) {
+        throw std::invalid_argument("negative result document count");
+    }
     
-    std::vector<Document> filtered_documents;
-    for (const Document& document : matched_documents) {
-        const auto document_status = document_id_to_document_data_.at(document.id).status;
-        const auto document_rating = document_id_to_document_data_.at(document.id).rating;
+    EvaluationStatistics statistics;
+    TopDocuments top_documents(static_cast<size_t>(options.max_result_document_count));
+    
+    if (options.matching == Matching::all) {
+        FindTopDocumentsConjunctive(query, options.collection_statistics, predicate, filter, top_documents, statistics);
+    } else if (options.evaluation == Evaluation::block_max_wand) {
+        FindTopDocumentsBlockMaxWand(query, options.collection_statistics, predicate, filter, top_documents, statistics);
+    } else if (options.evaluation == Evaluation::max_score) {
+        FindTopDocumentsMaxScore(query, options.collection_statistics, predicate, filter, top_documents, statistics);
+    } else {
+        RelevanceAccumulator& accumulator = GetThreadAccumulator();
         
-        if (predicate(document.id, document_status, document_rating)) {
-            filtered_documents.push_back(document);
-        }
+        FindAllDocuments(query, options.collection_statistics, filter, accumulator, statistics);
+        
+        int document_indexes[kPredicateBatchSize] = {};
+        double relevances[kPredicateBatchSize];
+        bool accepted[kPredicateBatchSize];
+        size_t batch_size = 0;
+        
+        const auto push_batch = [&] {
+            documents_.Filter(document_indexes, batch_size, predicate, accepted);
+            
+            for (size_t i = 0; i < batch_size; ++i) {
+                if (accepted[i]) {
+                    top_documents.Push({documents_.GetId(document_indexes[i]), relevances[i], documents_.GetRating(document_indexes[i])});
+                }
+            }
+            
+            batch_size = 0;
+        };
+        
+        accumulator.ForEachMatched([&](int document_index, double relevance) {
+            if (deleted_documents_.Test(document_index)) {
+                return;
+            }
+            
+            document_indexes[batch_size] = document_index;
+            relevances[batch_size] = relevance;
+            
+            if (++batch_size == kPredicateBatchSize) {
+                push_batch();
+            }
+        });
+        
+        push_batch();
+    }
+    
+    if (options.statistics != nullptr) {
+        *options.statistics = statistics;
     }
     
-    std::sort(filtered_documents.begin(), filtered_documents.end(),
-              [](const Document& left, const Document& right) {
-        if (std::abs(left.relevance - right.relevance) < kAccuracy) {
-            return left.rating > right.rating;
-        } else {
-            return left.relevance > right.relevance;
+    return top_documents.Extract();
+} // FindTopDocuments
+
+template<typename Predicate>
+void SearchServer::FindTopDocumentsBlockMaxWand(const Query& query, const CollectionStatistics* collection_statistics,
+                                                Predicate predicate, const DocumentFilter& filter, TopDocuments& top_documents,
+                                                EvaluationStatistics& statistics) const {
+    QueryArena::Scope scope;
+    
+    std::pmr::deque<TermCursor> plus_cursors(scope.GetResource());
+    Exclusions exclusions(scope.GetResource());
+    
+    CreateCursors(query, collection_statistics, plus_cursors, exclusions, statistics);
+    exclusions.filter = filter;
+    
+    std::pmr::vector<TermCursor*> cursors(scope.GetResource());
+    for (TermCursor& term_cursor : plus_cursors) {
+        cursors.push_back(&term_cursor);
+    }
+    
+    while (true) {
+        std::sort(cursors.begin(), cursors.end(), [](const TermCursor* left, const TermCursor* right) {
+            return left->cursor.GetDocumentId() < right->cursor.GetDocumentId();
+        });
+        
+        const double threshold = top_documents.GetThreshold();
+        
+        // the first cursor whose prefix of maximal scores can beat the threshold
+        size_t pivot = cursors.size();
+        double upper_bound = 0.0;
+        
+        for (size_t i = 0; i < cursors.size() && cursors[i]->cursor.GetDocumentId() != PostingCursor::kEndDocumentId; ++i) {
+            upper_bound += cursors[i]->max_score;
+            
+            if (upper_bound > threshold) {
+                pivot = i;
+                break;
+            }
         }
+        
+        if (pivot == cursors.size()) {
+            break;
+        }
+        
+        const int pivot_document_index = cursors[pivot]->cursor.GetDocumentId();
+        
+        while (pivot + 1 < cursors.size() && cursors[pivot + 1]->cursor.GetDocumentId() == pivot_document_index) {
+            ++pivot;
+        }
+        
+        double block_upper_bound = 0.0;
+        int block_last_document_index = PostingCursor::kEndDocumentId;
+        
+        for (size_t i = 0; i <= pivot; ++i) {
+            cursors[i]->cursor.ShallowSeek(pivot_document_index);
+            
+            block_upper_bound += cursors[i]->cursor.GetShallowBlockMaxTermFrequency() * cursors[i]->inverse_document_frequency;
+            block_last_document_index = std::min(block_last_document_index, cursors[i]->cursor.GetShallowBlockLastDocumentId());
+        }
+        
+        if (block_upper_bound <= threshold) {
+            // nothing up to the end of the shortest current block can get into the top,
+            // except the document of the next cursor, which also gets the score of that cursor
+            int next_document_index = block_last_document_index != PostingCursor::kEndDocumentId
+                                    ? block_last_document_index + 1
+                                    : PostingCursor::kEndDocumentId;
+            
+            if (pivot + 1 < cursors.size()) {
+                next_document_index = std::min(next_document_index, cursors[pivot + 1]->cursor.GetDocumentId());
+            }
+            
+            for (size_t i = 0; i <= pivot; ++i) {
+                cursors[i]->cursor.NextGreaterOrEqual(next_document_index);
+            }
+            
+            continue;
+        }
+        
+        if (cursors[0]->cursor.GetDocumentId() != pivot_document_index) {
+            // documents before the pivot cannot gather enough score
+            for (size_t i = 0; i < pivot; ++i) {
+                cursors[i]->cursor.NextGreaterOrEqual(pivot_document_index);
+            }
+            
+            continue;
+        }
+        
+        // rejected documents are stepped over without reading their postings
+        if (deleted_documents_.Test(pivot_document_index) || IsExcluded(exclusions, pivot_document_index)) {
+            for (size_t i = 0; i <= pivot; ++i) {
+                cursors[i]->cursor.Next();
+            }
+            
+            continue;
+        }
+        
+        double relevance = 0.0;
+        
+        for (size_t i = 0; i <= pivot; ++i) {
+            relevance += cursors[i]->cursor.GetTermFrequency() * cursors[i]->inverse_document_frequency;
+            cursors[i]->cursor.Next();
+        }
+        
+        statistics.postings_scored += pivot + 1;
+        ++statistics.documents_scored;
+        
+        if (predicate(documents_.GetId(pivot_document_index), documents_.GetStatus(pivot_document_index), documents_.GetRating(pivot_document_index))) {
+            top_documents.Push({documents_.GetId(pivot_document_index), relevance, documents_.GetRating(pivot_document_index)});
+        }
+    }
+} // FindTopDocumentsBlockMaxWand
+
+template<typename Predicate>
+void SearchServer::FindTopDocumentsMaxScore(const Query& query, const CollectionStatistics* collection_statistics,
+                                            Predicate predicate, const DocumentFilter& filter, TopDocuments& top_documents,
+                                            EvaluationStatistics& statistics) const {
+    QueryArena::Scope scope;
+    
+    std::pmr::deque<TermCursor> plus_cursors(scope.GetResource());
+    Exclusions exclusions(scope.GetResource());
+    
+    CreateCursors(query, collection_statistics, plus_cursors, exclusions, statistics);
+    exclusions.filter = filter;
+    
+    std::pmr::vector<TermCursor*> cursors(scope.GetResource());
+    for (TermCursor& term_cursor : plus_cursors) {
+        cursors.push_back(&term_cursor);
+    }
+    
+    std::sort(cursors.begin(), cursors.end(), [](const TermCursor* left, const TermCursor* right) {
+        return left->max_score < right->max_score;
     });
     
-    if (static_cast<int>(filtered_documents.size()) > kMaxResultDocumentCount) {
-        filtered_documents.resize(static_cast<size_t>(kMaxResultDocumentCount));
+    // upper_bounds[i] is the maximal total contribution of the terms up to i
+    std::pmr::vector<double> upper_bounds(cursors.size(), scope.GetResource());
+    double upper_bound = 0.0;
+    
+    for (size_t i = 0; i < cursors.size(); ++i) {
+        upper_bound += cursors[i]->max_score;
+        upper_bounds[i] = upper_bound;
     }
     
-    return filtered_documents;
-} // FindTopDocuments
+    // terms before first_essential cannot get a document into the top without essential ones
+    size_t first_essential = 0;
+    
+    while (first_essential < cursors.size()) {
+        const double threshold = top_documents.GetThreshold();
+        
+        while (first_essential < cursors.size() && upper_bounds[first_essential] <= threshold) {
+            ++first_essential;
+        }
+        
+        int document_index = PostingCursor::kEndDocumentId;
+        
+        for (size_t i = first_essential; i < cursors.size(); ++i) {
+            document_index = std::min(document_index, cursors[i]->cursor.GetDocumentId());
+        }
+        
+        if (document_index == PostingCursor::kEndDocumentId) {
+            break;
+        }
+        
+        // rejected documents are stepped over without reading their postings
+        if (deleted_documents_.Test(document_index) || IsExcluded(exclusions, document_index)) {
+            for (size_t i = first_essential; i < cursors.size(); ++i) {
+                if (cursors[i]->cursor.GetDocumentId() == document_index) {
+                    cursors[i]->cursor.Next();
+                }
+            }
+            
+            continue;
+        }
+        
+        double relevance = 0.0;
+        
+        for (size_t i = first_essential; i < cursors.size(); ++i) {
+            if (cursors[i]->cursor.GetDocumentId() == document_index) {
+                relevance += cursors[i]->cursor.GetTermFrequency() * cursors[i]->inverse_document_frequency;
+                cursors[i]->cursor.Next();
+                
+                ++statistics.postings_scored;
+            }
+        }
+        
+        bool is_pruned = false;
+        
+        for (size_t i = first_essential; i-- > 0;) {
+            if (relevance + upper_bounds[i] <= threshold) {
+                is_pruned = true;
+                break;
+            }
+            
+            cursors[i]->cursor.NextGreaterOrEqual(document_index);
+            
+            if (cursors[i]->cursor.GetDocumentId() == document_index) {
+                relevance += cursors[i]->cursor.GetTermFrequency() * cursors[i]->inverse_document_frequency;
+                
+                ++statistics.postings_scored;
+            }
+        }
+        
+        ++statistics.documents_scored;
+        
+        if (is_pruned) {
+            continue;
+        }
+        
+        if (predicate(documents_.GetId(document_index), documents_.GetStatus(document_index), documents_.GetRating(document_index))) {
+            top_documents.Push({documents_.GetId(document_index), relevance, documents_.GetRating(document_index)});
+        }
+    }
+} // FindTopDocumentsMaxScore
+
+template<typename Predicate>
+void SearchServer::FindTopDocumentsConjunctive(const Query& query, const CollectionStatistics* collection_statistics,
+                                               Predicate predicate, const DocumentFilter& filter, TopDocuments& top_documents,
+                                               EvaluationStatistics& statistics) const {
+    if (query.has_missing_plus_terms || query.plus_terms.empty()) {
+        return;
+    }
+    
+    QueryArena::Scope scope;
+    
+    std::pmr::deque<TermCursor> plus_cursors(scope.GetResource());
+    Exclusions exclusions(scope.GetResource());
+    
+    CreateCursors(query, collection_statistics, plus_cursors, exclusions, statistics);
+    exclusions.filter = filter;
+    
+    // a term of only removed documents leaves nothing to match
+    if (plus_cursors.size() < query.plus_terms.size()) {
+        return;
+    }
+    
+    int document_indexes[kPredicateBatchSize] = {};
+    bool accepted[kPredicateBatchSize];
+    size_t batch_size = 0;
+    
+    // every candidate matches, so the predicate goes first and only accepted documents are scored
+    const auto score_batch = [&] {
+        documents_.Filter(document_indexes, batch_size, predicate, accepted);
+        
+        for (size_t i = 0; i < batch_size; ++i) {
+            if (!accepted[i]) {
+                continue;
+            }
+            
+            const int document_index = document_indexes[i];
+            double relevance = 0.0;
+            
+            for (TermCursor& term_cursor : plus_cursors) {
+                term_cursor.cursor.NextGreaterOrEqual(document_index);
+                relevance += term_cursor.cursor.GetTermFrequency() * term_cursor.inverse_document_frequency;
+            }
+            
+            statistics.postings_scored += plus_cursors.size();
+            ++statistics.documents_scored;
+            
+            top_documents.Push({documents_.GetId(document_index), relevance, documents_.GetRating(document_index)});
+        }
+        
+        batch_size = 0;
+    };
+    
+    for (const int document_index : IntersectPostings(query, scope.GetResource())) {
+        if (deleted_documents_.Test(document_index) || IsExcluded(exclusions, document_index)) {
+            continue;
+        }
+        
+        document_indexes[batch_size] = document_index;
+        
+        if (++batch_size == kPredicateBatchSize) {
+            score_batch();
+        }
+    }
+    
+    score_batch();
+} // FindTopDocumentsConjunctive
 
 namespace search_server_helpers {
 
@@ -179,7 +825,7 @@ void PrintMatchDocumentResult(int document_id, const std::vector<std::string>& w
 void AddDocument(SearchServer& search_server, int document_id, const std::string& document, DocumentStatus status,
                  const std::vector<int>& ratings);
 
-void FindTopDocuments(const SearchServer& search_server, const std::string& raw_query);
+void FindTopDocuments(const SearchServer& search_server, std::string_view raw_query);
 
 void MatchDocuments(const SearchServer& search_server, const std::string& query);
 
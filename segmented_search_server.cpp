@@ -0,0 +1,333 @@
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+#include "segmented_search_server.h"
+
+using namespace std::literals;
+
+SegmentedSearchServer::SegmentedSearchServer(const std::string& stop_words, SegmentOptions options)
+    : stop_words_(stop_words), options_(options), write_buffer_(stop_words) {
+    if (options_.write_buffer_document_count <= 0) {
+        throw std::invalid_argument("write buffer must hold at least one document"s);
+    }
+
+    if (options_.segments_per_tier < 2) {
+        throw std::invalid_argument("at least two segments per tier are required to merge"s);
+    }
+}
+
+SegmentedSearchServer::~SegmentedSearchServer() {
+    // the merge thread refers to this object
+    if (merge_.valid()) {
+        merge_.wait();
+    }
+}
+
+bool SegmentedSearchServer::AddDocument(int document_id, const std::string& document,
+                                        DocumentStatus status, const std::vector<int>& ratings) {
+    if (document_ids_.count(document_id) > 0) {
+        throw std::invalid_argument("repeating ids are not allowed"s);
+    }
+
+    write_buffer_.AddDocument(document_id, document, status, ratings);
+    document_ids_.insert(document_id);
+
+    if (write_buffer_.GetDocumentCount() >= options_.write_buffer_document_count) {
+        FreezeWriteBuffer();
+    }
+
+    return true;
+} // AddDocument
+
+void SegmentedSearchServer::RemoveDocument(int document_id) {
+    if (document_ids_.erase(document_id) == 0) {
+        return;
+    }
+
+    if (write_buffer_.ContainsDocument(document_id)) {
+        write_buffer_.RemoveDocument(document_id);
+        return;
+    }
+
+    Segment rewritten_segment;
+
+    {
+        std::lock_guard guard(segments_mutex_);
+
+        for (Segment& segment : segments_) {
+            if (segment.ContainsDocument(document_id)) {
+                if (RemoveFromSegment(segment, document_id)) {
+                    rewritten_segment = segment;
+                }
+
+                break;
+            }
+        }
+    }
+
+    // queries go on with the tombstones meanwhile
+    if (rewritten_segment.server) {
+        RewriteSegment(rewritten_segment);
+    }
+} // RemoveDocument
+
+bool SegmentedSearchServer::RemoveFromSegment(Segment& segment, int document_id) {
+    TombstoneBuffers& buffers = tombstone_buffers_[segment.id];
+    std::shared_ptr<DocumentBitmap> tombstones = std::move(buffers.standby);
+
+    // segments are copied out under the lock, so once the last reader lets the standby go it is ours
+    if (tombstones && tombstones.use_count() == 1) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        for (const int standby_document_id : buffers.standby_document_ids) {
+            segment.server->MarkRemoved(standby_document_id, *tombstones);
+        }
+    } else {
+        tombstones = buffers.current ? std::make_shared<DocumentBitmap>(*buffers.current) : std::make_shared<DocumentBitmap>();
+    }
+
+    segment.server->MarkRemoved(document_id, *tombstones);
+
+    buffers.standby = std::move(buffers.current);
+    buffers.standby_document_ids.assign(1, document_id);
+    buffers.current = tombstones;
+    segment.tombstones = std::move(tombstones);
+
+    // rewriting costs as much as the segment, so it is paid for by that many removals
+    return static_cast<double>(segment.tombstones->Count())
+         > options_.max_removed_ratio * static_cast<double>(segment.server->GetDocumentCount());
+} // RemoveFromSegment
+
+void SegmentedSearchServer::RewriteSegment(const Segment& source) {
+    auto server = std::make_shared<SearchServer>(stop_words_);
+    server->MergeFrom(*source.server, source.GetRemovedDocuments());
+
+    if (options_.compress_segments) {
+        server->CompressPostings(Policy::sequential, options_.quantization);
+    }
+
+    std::lock_guard guard(segments_mutex_);
+
+    const auto current = std::find_if(segments_.begin(), segments_.end(), [&source](const Segment& segment) {
+        return segment.id == source.id;
+    });
+
+    // a merge that consumed the segment meanwhile has dropped the removed documents itself
+    if (current == segments_.end() || current->server != source.server || current->tombstones != source.tombstones) {
+        return;
+    }
+
+    current->server = std::move(server);
+    current->tombstones.reset();
+    tombstone_buffers_.erase(source.id);
+} // RewriteSegment
+
+const DocumentBitmap* SegmentedSearchServer::Segment::GetRemovedDocuments() const {
+    return tombstones.get();
+}
+
+bool SegmentedSearchServer::Segment::ContainsDocument(int document_id) const {
+    // an id removed from a segment may be added again and go to another one
+    return server->ContainsDocument(document_id, tombstones.get());
+}
+
+int SegmentedSearchServer::GetDocumentCount() const {
+    return static_cast<int>(document_ids_.size());
+}
+
+size_t SegmentedSearchServer::GetSegmentCount() const {
+    std::lock_guard guard(segments_mutex_);
+
+    return segments_.size();
+}
+
+void SegmentedSearchServer::Flush() {
+    if (write_buffer_.GetDocumentCount() > 0) {
+        FreezeWriteBuffer();
+    }
+}
+
+void SegmentedSearchServer::WaitForMerges() {
+    if (merge_.valid()) {
+        // rethrows what the merge thread threw
+        merge_.get();
+    }
+
+    RunMerges();
+}
+
+std::vector<Document> SegmentedSearchServer::FindTopDocuments(const SearchOptions& options, const std::string& raw_query,
+                                                              const DocumentStatus& desired_status) const {
+    // the status itself is handed down, so every server skips documents of other statuses while walking postings
+    return FindTopDocuments<DocumentStatus>(options, raw_query, desired_status);
+}
+
+std::vector<Document> SegmentedSearchServer::FindTopDocuments(const std::string& raw_query,
+                                                              const DocumentStatus& desired_status) const {
+    return FindTopDocuments(SearchOptions{}, raw_query, desired_status);
+}
+
+std::tuple<std::vector<std::string>, DocumentStatus> SegmentedSearchServer::MatchDocument(const std::string& raw_query,
+                                                                                          int document_id) const {
+    for (const Segment& server : GetSearchableServers(GetSegments())) {
+        if (server.ContainsDocument(document_id)) {
+            return server.server->MatchDocument(raw_query, document_id);
+        }
+    }
+
+    // throws the same way a single server does
+    return write_buffer_.MatchDocument(raw_query, document_id);
+} // MatchDocument
+
+std::map<std::string, double> SegmentedSearchServer::GetWordFrequencies(int document_id) const {
+    std::map<std::string, double> word_frequencies;
+
+    for (const Segment& server : GetSearchableServers(GetSegments())) {
+        if (server.ContainsDocument(document_id)) {
+            for (const auto& [word, term_frequency] : server.server->GetWordFrequencies(document_id)) {
+                word_frequencies.emplace(word, term_frequency);
+            }
+
+            break;
+        }
+    }
+
+    return word_frequencies;
+} // GetWordFrequencies
+
+std::set<int>::const_iterator SegmentedSearchServer::begin() const {
+    return document_ids_.begin();
+}
+
+std::set<int>::const_iterator SegmentedSearchServer::end() const {
+    return document_ids_.end();
+}
+
+std::vector<SegmentedSearchServer::Segment> SegmentedSearchServer::GetSegments() const {
+    std::lock_guard guard(segments_mutex_);
+
+    return segments_;
+}
+
+std::vector<SegmentedSearchServer::Segment> SegmentedSearchServer::GetSearchableServers(const std::vector<Segment>& segments) const {
+    std::vector<Segment> servers;
+    servers.reserve(segments.size() + 1);
+
+    // aliasing constructor, the buffer is owned by this object
+    servers.push_back(Segment{0, std::shared_ptr<const SearchServer>(std::shared_ptr<const SearchServer>(), &write_buffer_), nullptr});
+    servers.insert(servers.end(), segments.begin(), segments.end());
+
+    return servers;
+} // GetSearchableServers
+
+void SegmentedSearchServer::FreezeWriteBuffer() {
+    if (options_.compress_segments) {
+        write_buffer_.CompressPostings(Policy::sequential, options_.quantization);
+    }
+
+    {
+        std::lock_guard guard(segments_mutex_);
+
+        segments_.push_back(Segment{next_segment_id_++, std::make_shared<const SearchServer>(std::move(write_buffer_)), nullptr});
+    }
+
+    write_buffer_ = SearchServer(stop_words_);
+
+    ScheduleMerge();
+} // FreezeWriteBuffer
+
+size_t SegmentedSearchServer::GetTier(const SearchServer& segment) const {
+    size_t buffer_count = static_cast<size_t>(segment.GetDocumentCount() / options_.write_buffer_document_count);
+
+    size_t tier = 0;
+    while (buffer_count >= options_.segments_per_tier) {
+        buffer_count /= options_.segments_per_tier;
+        ++tier;
+    }
+
+    return tier;
+} // GetTier
+
+void SegmentedSearchServer::ScheduleMerge() {
+    // the running merge picks up new segments, WaitForMerges catches the ones it misses
+    if (merge_.valid() && merge_.wait_for(0s) != std::future_status::ready) {
+        return;
+    }
+
+    if (merge_.valid()) {
+        merge_.get();
+    }
+
+    if (options_.background_merges) {
+        merge_ = std::async(std::launch::async, [this] {
+            RunMerges();
+        });
+    } else {
+        RunMerges();
+    }
+} // ScheduleMerge
+
+void SegmentedSearchServer::RunMerges() {
+    while (true) {
+        std::vector<Segment> sources;
+
+        {
+            std::lock_guard guard(segments_mutex_);
+
+            std::map<size_t, std::vector<Segment>> tiers;
+            for (const Segment& segment : segments_) {
+                tiers[GetTier(*segment.server)].push_back(segment);
+            }
+
+            for (auto& [tier, tier_segments] : tiers) {
+                if (tier_segments.size() >= options_.segments_per_tier) {
+                    sources = std::move(tier_segments);
+                    break;
+                }
+            }
+        }
+
+        if (sources.empty()) {
+            return;
+        }
+
+        Merge(std::move(sources));
+    }
+} // RunMerges
+
+void SegmentedSearchServer::Merge(std::vector<Segment> sources) {
+    auto merged = std::make_shared<SearchServer>(stop_words_);
+
+    for (const Segment& source : sources) {
+        merged->MergeFrom(*source.server, source.GetRemovedDocuments());
+    }
+
+    if (options_.compress_segments) {
+        merged->CompressPostings(Policy::parallel, options_.quantization);
+    }
+
+    std::lock_guard guard(segments_mutex_);
+
+    for (const Segment& source : sources) {
+        const auto current = std::find_if(segments_.begin(), segments_.end(), [&source](const Segment& segment) {
+            return segment.id == source.id;
+        });
+
+        // documents removed from the source while it was being merged
+        if (current->server != source.server || current->tombstones != source.tombstones) {
+            for (const int document_id : *source.server) {
+                if (source.ContainsDocument(document_id) && !current->ContainsDocument(document_id)) {
+                    merged->RemoveDocument(document_id);
+                }
+            }
+        }
+
+        segments_.erase(current);
+        tombstone_buffers_.erase(source.id);
+    }
+
+    segments_.push_back(Segment{next_segment_id_++, std::move(merged), nullptr});
+} // Merge
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <execution>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "search_server.h"
+
+struct SegmentOptions {
+    // documents kept in the mutable write buffer before it is frozen into a segment
+    int write_buffer_document_count = 4096;
+
+    // a tier holds segments of roughly the same size, this many of them are merged into one of the next tier
+    size_t segments_per_tier = 4;
+
+    // frozen and merged segments move their postings into the compressed format
+    bool compress_segments = true;
+    Quantization quantization = Quantization::uint16;
+
+    // merges run on a background thread, otherwise on the thread that triggered them
+    bool background_merges = true;
+
+    // a segment is rewritten without its removed documents once they make up more than this share of it
+    double max_removed_ratio = 0.25;
+};
+
+// Log-structured index. New documents go into a small SearchServer used as a write
+// buffer. A full buffer is frozen into an immutable segment, and segments of the same
+// tier are merged into one larger segment in the background. Queries fan out across
+// the buffer and all segments with collection-wide document frequencies, so results
+// are the same as of a single SearchServer up to term frequency quantization.
+class SegmentedSearchServer {
+public:
+    explicit SegmentedSearchServer(const std::string& stop_words = std::string(), SegmentOptions options = SegmentOptions());
+
+    SegmentedSearchServer(const SegmentedSearchServer&) = delete;
+
+    SegmentedSearchServer& operator=(const SegmentedSearchServer&) = delete;
+
+    ~SegmentedSearchServer();
+
+public:
+    bool AddDocument(int document_id, const std::string& document,
+                     DocumentStatus status, const std::vector<int>& ratings);
+
+    void RemoveDocument(int document_id);
+
+    int GetDocumentCount() const;
+
+    // frozen segments, not counting the write buffer
+    size_t GetSegmentCount() const;
+
+    // freezes the write buffer even if it is not full
+    void Flush();
+
+    // also runs merges that became due while the last one was finishing
+    void WaitForMerges();
+
+    template<typename Predicate>
+    std::vector<Document> FindTopDocuments(const SearchOptions& options, const std::string& raw_query, Predicate predicate) const;
+
+    std::vector<Document> FindTopDocuments(const SearchOptions& options, const std::string& raw_query,
+                                           const DocumentStatus& desired_status = DocumentStatus::ACTUAL) const;
+
+    template<typename Predicate>
+    std::vector<Document> FindTopDocuments(const std::string& raw_query, Predicate predicate) const;
+
+    std::vector<Document> FindTopDocuments(const std::string& raw_query,
+                                           const DocumentStatus& desired_status = DocumentStatus::ACTUAL) const;
+
+    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(const std::string& raw_query, int document_id) const;
+
+    // words are copied, segments holding them may be merged away at any time
+    std::map<std::string, double> GetWordFrequencies(int document_id) const;
+
+    std::set<int>::const_iterator begin() const;
+
+    std::set<int>::const_iterator end() const;
+
+private:
+    struct Segment {
+        // survives rewrites, so a merge can tell which segments it consumed
+        std::uint64_t id = 0;
+        std::shared_ptr<const SearchServer> server;
+        // Documents removed from the segment, marked by its server. Shared with running queries
+        // and merges like the server, so a removal publishes another bitmap. Null until the first removal.
+        std::shared_ptr<const DocumentBitmap> tombstones;
+
+        const DocumentBitmap* GetRemovedDocuments() const;
+
+        // live in this segment
+        bool ContainsDocument(int document_id) const;
+    };
+
+    // Tombstones of a segment as two bitmaps: the published one, and the one published before,
+    // which misses the removals since. Once queries and merges let the previous one go, it catches
+    // up and takes the next removal, so removals do not copy the bitmap.
+    struct TombstoneBuffers {
+        std::shared_ptr<DocumentBitmap> current;
+        std::shared_ptr<DocumentBitmap> standby;
+        std::vector<int> standby_document_ids;
+    };
+
+private:
+    std::vector<Segment> GetSegments() const;
+
+    // buffer first as a segment without tombstones, then segments
+    std::vector<Segment> GetSearchableServers(const std::vector<Segment>& segments) const;
+
+    // Under segments_mutex_. Returns whether removed documents have grown past the share
+    // that gets the segment rewritten.
+    bool RemoveFromSegment(Segment& segment, int document_id);
+
+    // builds the segment anew without its removed documents, the lock is only taken to swap it in
+    void RewriteSegment(const Segment& source);
+
+    void FreezeWriteBuffer();
+
+    size_t GetTier(const SearchServer& segment) const;
+
+    void ScheduleMerge();
+
+    // merges tiers until none of them is full
+    void RunMerges();
+
+    void Merge(std::vector<Segment> sources);
+
+private:
+    std::string stop_words_;
+    SegmentOptions options_;
+
+    // only changed by the owning thread, shared with queries running on it through a non-owning pointer
+    SearchServer write_buffer_;
+
+    // guards segments_ and next_segment_id_ against the merge thread
+    mutable std::mutex segments_mutex_;
+    std::vector<Segment> segments_;
+    std::uint64_t next_segment_id_ = 0;
+
+    // by segment id, guarded by segments_mutex_
+    std::unordered_map<std::uint64_t, TombstoneBuffers> tombstone_buffers_;
+
+    std::future<void> merge_;
+
+    std::set<int> document_ids_;
+};
+
+template<typename Predicate>
+std::vector<Document> SegmentedSearchServer::FindTopDocuments(const SearchOptions& options, const std::string& raw_query,
+                                                              Predicate predicate) const {
+    const std::vector<Segment> servers = GetSearchableServers(GetSegments());
+
+    CollectionStatistics collection_statistics;
+    for (const Segment& server : servers) {
+        collection_statistics += server.server->GetCollectionStatistics(raw_query, server.GetRemovedDocuments());
+    }
+
+    std::vector<size_t> server_indexes(servers.size());
+    std::iota(server_indexes.begin(), server_indexes.end(), size_t{0});
+
+    std::vector<std::vector<Document>> server_documents(servers.size());
+    std::vector<EvaluationStatistics> server_statistics(servers.size());
+
+    std::for_each(std::execution::par, server_indexes.begin(), server_indexes.end(), [&](size_t server_index) {
+        SearchOptions server_options = options;
+        server_options.collection_statistics = &collection_statistics;
+        server_options.statistics = &server_statistics[server_index];
+        server_options.removed_documents = servers[server_index].GetRemovedDocuments();
+
+        server_documents[server_index] = servers[server_index].server->FindTopDocuments(server_options, raw_query, predicate);
+    });
+
+    if (options.statistics != nullptr) {
+        *options.statistics = {};
+
+        for (const EvaluationStatistics& statistics : server_statistics) {
+            options.statistics->postings_total += statistics.postings_total;
+            options.statistics->postings_scored += statistics.postings_scored;
+            options.statistics->documents_scored += statistics.documents_scored;
+        }
+    }
+
+    return TopDocuments::Merge(server_documents, static_cast<size_t>(options.max_result_document_count));
+} // FindTopDocuments
+
+template<typename Predicate>
+std::vector<Document> SegmentedSearchServer::FindTopDocuments(const std::string& raw_query, Predicate predicate) const {
+    return FindTopDocuments(SearchOptions{}, raw_query, predicate);
+}
@@ -0,0 +1,75 @@
+#include <cstdint>
+#include <stdexcept>
+
+#include "sharded_search_server.h"
+
+using namespace std::literals;
+
+ShardedSearchServer::ShardedSearchServer(size_t shard_count, const std::string& stop_words) {
+    if (shard_count == 0) {
+        throw std::invalid_argument("at least one shard is required"s);
+    }
+
+    shards_.assign(shard_count, SearchServer(stop_words));
+}
+
+bool ShardedSearchServer::AddDocument(int document_id, const std::string& document,
+                                      DocumentStatus status, const std::vector<int>& ratings) {
+    if (document_ids_.count(document_id) > 0) {
+        throw std::invalid_argument("repeating ids are not allowed"s);
+    }
+
+    shards_[GetShardIndex(document_id)].AddDocument(document_id, document, status, ratings);
+    document_ids_.insert(document_id);
+
+    return true;
+} // AddDocument
+
+void ShardedSearchServer::RemoveDocument(int document_id) {
+    if (document_ids_.erase(document_id) > 0) {
+        shards_[GetShardIndex(document_id)].RemoveDocument(document_id);
+    }
+}
+
+int ShardedSearchServer::GetDocumentCount() const {
+    return static_cast<int>(document_ids_.size());
+}
+
+size_t ShardedSearchServer::GetShardCount() const {
+    return shards_.size();
+}
+
+std::vector<Document> ShardedSearchServer::FindTopDocuments(const SearchOptions& options, const std::string& raw_query,
+                                                            const DocumentStatus& desired_status) const {
+    // the status itself is handed down, so every server skips documents of other statuses while walking postings
+    return FindTopDocuments<DocumentStatus>(options, raw_query, desired_status);
+}
+
+std::vector<Document> ShardedSearchServer::FindTopDocuments(const std::string& raw_query,
+                                                            const DocumentStatus& desired_status) const {
+    return FindTopDocuments(SearchOptions{}, raw_query, desired_status);
+}
+
+std::tuple<std::vector<std::string>, DocumentStatus> ShardedSearchServer::MatchDocument(const std::string& raw_query,
+                                                                                        int document_id) const {
+    return shards_[GetShardIndex(document_id)].MatchDocument(raw_query, document_id);
+}
+
+WordFrequencies ShardedSearchServer::GetWordFrequencies(int document_id) const {
+    return shards_[GetShardIndex(document_id)].GetWordFrequencies(document_id);
+}
+
+std::set<int>::const_iterator ShardedSearchServer::begin() const {
+    return document_ids_.begin();
+}
+
+std::set<int>::const_iterator ShardedSearchServer::end() const {
+    return document_ids_.end();
+}
+
+size_t ShardedSearchServer::GetShardIndex(int document_id) const {
+    // Fibonacci hashing spreads consecutive ids evenly
+    const std::uint64_t hash = static_cast<std::uint64_t>(static_cast<std::uint32_t>(document_id)) * 0x9E3779B97F4A7C15ull;
+
+    return static_cast<size_t>(hash >> 32) % shards_.size();
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "search_server.h"
+
+// Spreads documents over several SearchServer shards by a hash of their id and
+// searches all shards in parallel. Shards score with collection-wide document
+// frequencies, so results are the same as of a single SearchServer.
+class ShardedSearchServer {
+public:
+    explicit ShardedSearchServer(size_t shard_count, const std::string& stop_words = std::string());
+
+public:
+    bool AddDocument(int document_id, const std::string& document,
+                     DocumentStatus status, const std::vector<int>& ratings);
+
+    void RemoveDocument(int document_id);
+
+    int GetDocumentCount() const;
+
+    size_t GetShardCount() const;
+
+    template<typename Predicate>
+    std::vector<Document> FindTopDocuments(const SearchOptions& options, const std::string& raw_query, Predicate predicate) const;
+
+    std::vector<Document> FindTopDocuments(const SearchOptions& options, const std::string& raw_query,
+                                           const DocumentStatus& desired_status = DocumentStatus::ACTUAL) const;
+
+    template<typename Predicate>
+    std::vector<Document> FindTopDocuments(const std::string& raw_query, Predicate predicate) const;
+
+    std::vector<Document> FindTopDocuments(const std::string& raw_query,
+                                           const DocumentStatus& desired_status = DocumentStatus::ACTUAL) const;
+
+    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(const std::string& raw_query, int document_id) const;
+
+    WordFrequencies GetWordFrequencies(int document_id) const;
+
+    std::set<int>::const_iterator begin() const;
+
+    std::set<int>::const_iterator end() const;
+
+private:
+    size_t GetShardIndex(int document_id) const;
+
+private:
+    std::vector<SearchServer> shards_;
+
+    std::set<int> document_ids_;
+};
+
+template<typename Predicate>
+std::vector<Document> ShardedSearchServer::FindTopDocuments(const SearchOptions& options, const std::string& raw_query,
+                                                            Predicate predicate) const {
+    CollectionStatistics collection_statistics;
+    for (const SearchServer& shard : shards_) {
+        collection_statistics += shard.GetCollectionStatistics(raw_query);
+    }
+
+    std::vector<size_t> shard_indexes(shards_.size());
+    std::iota(shard_indexes.begin(), shard_indexes.end(), size_t{0});
+
+    std::vector<std::vector<Document>> shard_documents(shards_.size());
+    std::vector<EvaluationStatistics> shard_statistics(shards_.size());
+
+    std::for_each(std::execution::par, shard_indexes.begin(), shard_indexes.end(), [&](size_t shard_index) {
+        SearchOptions shard_options = options;
+        shard_options.collection_statistics = &collection_statistics;
+        shard_options.statistics = &shard_statistics[shard_index];
+
+        shard_documents[shard_index] = shards_[shard_index].FindTopDocuments(shard_options, raw_query, predicate);
+    });
+
+    if (options.statistics != nullptr) {
+        *options.statistics = {};
+
+        for (const EvaluationStatistics& statistics : shard_statistics) {
+            options.statistics->postings_total += statistics.postings_total;
+            options.statistics->postings_scored += statistics.postings_scored;
+            options.statistics->documents_scored += statistics.documents_scored;
+        }
+    }
+
+    return TopDocuments::Merge(shard_documents, static_cast<size_t>(options.max_result_document_count));
+} // FindTopDocuments
+
+template<typename Predicate>
+std::vector<Document> ShardedSearchServer::FindTopDocuments(const std::string& raw_query, Predicate predicate) const {
+    return FindTopDocuments(SearchOptions{}, raw_query, predicate);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+// Vector of trivially copyable values that keeps up to InlineCapacity of them in place.
+// Longer contents move, all of them at once, to a vector taken from the memory resource.
+template <typename T, size_t InlineCapacity>
+class SmallVector {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    explicit SmallVector(std::pmr::memory_resource* resource) : overflow_(resource) {}
+
+public:
+    size_t size() const {
+        return overflow_.empty() ? inline_size_ : overflow_.size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    T* begin() {
+        return overflow_.empty() ? inline_ : overflow_.data();
+    }
+
+    T* end() {
+        return begin() + size();
+    }
+
+    const T* begin() const {
+        return overflow_.empty() ? inline_ : overflow_.data();
+    }
+
+    const T* end() const {
+        return begin() + size();
+    }
+
+    const T& operator[](size_t index) const {
+        return begin()[index];
+    }
+
+    void push_back(const T& value) {
+        if (!overflow_.empty()) {
+            overflow_.push_back(value);
+        } else if (inline_size_ < InlineCapacity) {
+            inline_[inline_size_++] = value;
+        } else {
+            overflow_.reserve(2 * InlineCapacity);
+            overflow_.assign(inline_, inline_ + inline_size_);
+            overflow_.push_back(value);
+        }
+    }
+
+    // only shrinks
+    void resize(size_t size) {
+        assert(size <= this->size());
+
+        if (overflow_.empty()) {
+            inline_size_ = size;
+        } else if (size > InlineCapacity) {
+            overflow_.resize(size);
+        } else {
+            std::copy(overflow_.begin(), overflow_.begin() + size, inline_);
+            inline_size_ = size;
+            overflow_.clear();
+        }
+    }
+
+    // contiguous, so both passes are plain loops over an array
+    void SortAndDeduplicate() {
+        std::sort(begin(), end());
+        resize(static_cast<size_t>(std::unique(begin(), end()) - begin()));
+    }
+
+private:
+    T inline_[InlineCapacity];
+    size_t inline_size_ = 0;
+
+    std::pmr::vector<T> overflow_;
+};
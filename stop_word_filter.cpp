@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <cstring>
+
+#include "stop_word_filter.h"
+
+void StopWordFilter::Insert(std::string_view word) {
+    if (word.empty() || Contains(word)) {
+        return;
+    }
+
+    if (2 * (size_ + 1) > slots_.size()) {
+        Rehash(std::max<size_t>(8, 2 * slots_.size()));
+    }
+
+    Slot slot;
+    slot.hash = HashStopWord(word);
+    slot.offset = static_cast<std::uint32_t>(words_.size());
+    slot.length = static_cast<std::uint32_t>(word.size());
+
+    words_.append(word);
+    Place(slot);
+
+    length_mask_ |= GetLengthBit(word.size());
+    ++size_;
+} // Insert
+
+bool StopWordFilter::Contains(std::string_view word) const {
+    if ((length_mask_ & GetLengthBit(word.size())) == 0 || word.empty()) {
+        return false;
+    }
+
+    const std::uint64_t hash = HashStopWord(word);
+    const size_t mask = slots_.size() - 1;
+
+    for (size_t index = hash & mask; slots_[index].length != 0; index = (index + 1) & mask) {
+        const Slot& slot = slots_[index];
+
+        if (slot.hash == hash && slot.length == word.size()
+            && std::memcmp(words_.data() + slot.offset, word.data(), word.size()) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+} // Contains
+
+size_t StopWordFilter::size() const {
+    return size_;
+}
+
+bool StopWordFilter::empty() const {
+    return size_ == 0;
+}
+
+void StopWordFilter::Rehash(size_t capacity) {
+    std::vector<Slot> slots(capacity);
+    slots.swap(slots_);
+
+    for (const Slot& slot : slots) {
+        if (slot.length != 0) {
+            Place(slot);
+        }
+    }
+} // Rehash
+
+void StopWordFilter::Place(const Slot& slot) {
+    const size_t mask = slots_.size() - 1;
+
+    size_t index = slot.hash & mask;
+    while (slots_[index].length != 0) {
+        index = (index + 1) & mask;
+    }
+
+    slots_[index] = slot;
+} // Place
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// FNV-1a, usable at compile time
+constexpr std::uint64_t HashStopWord(std::string_view word) {
+    std::uint64_t hash = 14695981039346656037ull;
+
+    for (const char c : word) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+// Open-addressed set of stop words, rebuilt when words are added. Lengths of the words are
+// kept in a bit mask, so most words are rejected before they are hashed.
+class StopWordFilter {
+public:
+    void Insert(std::string_view word);
+
+    bool Contains(std::string_view word) const;
+
+    size_t size() const;
+
+    bool empty() const;
+
+private:
+    // longer words share the last bit of the length mask
+    static constexpr size_t kMaxMaskedLength = 63;
+
+    static std::uint64_t GetLengthBit(size_t length) {
+        return std::uint64_t{1} << (length < kMaxMaskedLength ? length : kMaxMaskedLength);
+    }
+
+private:
+    struct Slot {
+        std::uint64_t hash = 0;
+        std::uint32_t offset = 0;
+        // 0 marks an empty slot, the empty word is never a stop word
+        std::uint32_t length = 0;
+    };
+
+private:
+    // at most half of the slots are taken
+    void Rehash(size_t capacity);
+
+    void Place(const Slot& slot);
+
+private:
+    // the words back to back
+    std::string words_;
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+    std::uint64_t length_mask_ = 0;
+};
+
+// The same filter for stop words known at compile time, the views must outlive it.
+template <size_t WordCount>
+class StaticStopWordFilter {
+public:
+    constexpr explicit StaticStopWordFilter(const std::array<std::string_view, WordCount>& words) {
+        for (const std::string_view word : words) {
+            if (word.empty() || Contains(word)) {
+                continue;
+            }
+
+            length_mask_ |= GetLengthBit(word.size());
+
+            size_t index = HashStopWord(word) & (kCapacity - 1);
+            while (!slots_[index].empty()) {
+                index = (index + 1) & (kCapacity - 1);
+            }
+
+            slots_[index] = word;
+        }
+    }
+
+    constexpr bool Contains(std::string_view word) const {
+        if (word.empty() || (length_mask_ & GetLengthBit(word.size())) == 0) {
+            return false;
+        }
+
+        for (size_t index = HashStopWord(word) & (kCapacity - 1); !slots_[index].empty(); index = (index + 1) & (kCapacity - 1)) {
+            if (slots_[index] == word) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+private:
+    static constexpr size_t GetCapacity() {
+        size_t capacity = 2;
+
+        while (capacity < 2 * WordCount) {
+            capacity *= 2;
+        }
+
+        return capacity;
+    }
+
+    static constexpr std::uint64_t GetLengthBit(size_t length) {
+        return std::uint64_t{1} << (length < 63 ? length : 63);
+    }
+
+private:
+    static constexpr size_t kCapacity = GetCapacity();
+
+private:
+    std::array<std::string_view, kCapacity> slots_{};
+    std::uint64_t length_mask_ = 0;
+};
@@ -1,9 +1,161 @@
+#include <algorithm>
+#include <cstdint>
 #include <sstream>
 
 #include "string_processing.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAS_X86_KERNELS
+#include <immintrin.h>
+#endif
+
 namespace string_processing {
 
+namespace {
+
+// Turns space masks of consecutive blocks into words. Bit k of a mask stands for byte k of the block.
+template <typename Words>
+class WordScanner {
+public:
+    WordScanner(std::string_view text, Words& words) : text_(text), words_(words) {}
+
+    void Consume(size_t block_begin, size_t block_size, std::uint64_t space_mask) {
+        const std::uint64_t block_mask = block_size == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << block_size) - 1;
+        const std::uint64_t word_mask = ~space_mask & block_mask;
+
+        // a word starts or ends wherever a byte differs from the one before it
+        std::uint64_t boundaries = word_mask ^ ((word_mask << 1) | (is_in_word_ ? 1u : 0u));
+        boundaries &= block_mask;
+
+        while (boundaries != 0) {
+            const size_t position = block_begin + static_cast<size_t>(__builtin_ctzll(boundaries));
+
+            if (is_in_word_) {
+                words_.push_back(text_.substr(word_begin_, position - word_begin_));
+            } else {
+                word_begin_ = position;
+            }
+
+            is_in_word_ = !is_in_word_;
+            boundaries &= boundaries - 1;
+        }
+    }
+
+    void Finish() {
+        if (is_in_word_) {
+            words_.push_back(text_.substr(word_begin_));
+        }
+    }
+
+private:
+    std::string_view text_;
+    Words& words_;
+
+    size_t word_begin_ = 0;
+    bool is_in_word_ = false;
+};
+
+template <typename Words>
+bool ScanScalar(std::string_view text, size_t begin, WordScanner<Words>& scanner) {
+    for (size_t block_begin = begin; block_begin < text.size(); block_begin += 64) {
+        const size_t block_size = std::min<size_t>(64, text.size() - block_begin);
+
+        std::uint64_t space_mask = 0;
+
+        for (size_t i = 0; i < block_size; ++i) {
+            const auto byte = static_cast<unsigned char>(text[block_begin + i]);
+
+            if (byte < ' ') {
+                return false;
+            }
+
+            space_mask |= std::uint64_t{byte == ' '} << i;
+        }
+
+        scanner.Consume(block_begin, block_size, space_mask);
+    }
+
+    return true;
+} // ScanScalar
+
+#ifdef HAS_X86_KERNELS
+
+template <typename Words>
+__attribute__((target("sse2")))
+bool ScanSse2(std::string_view text, WordScanner<Words>& scanner) {
+    constexpr size_t kBlockSize = 16;
+
+    const __m128i spaces = _mm_set1_epi8(' ');
+    // bytes below 0x20 have none of the three high bits set
+    const __m128i high_bits = _mm_set1_epi8(static_cast<char>(0xE0));
+    const __m128i zeros = _mm_setzero_si128();
+
+    size_t block_begin = 0;
+
+    for (; block_begin + kBlockSize <= text.size(); block_begin += kBlockSize) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + block_begin));
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(block, high_bits), zeros)) != 0) {
+            return false;
+        }
+
+        const auto space_mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, spaces)));
+        scanner.Consume(block_begin, kBlockSize, space_mask);
+    }
+
+    return ScanScalar(text, block_begin, scanner);
+} // ScanSse2
+
+template <typename Words>
+__attribute__((target("avx2")))
+bool ScanAvx2(std::string_view text, WordScanner<Words>& scanner) {
+    constexpr size_t kBlockSize = 32;
+
+    const __m256i spaces = _mm256_set1_epi8(' ');
+    const __m256i high_bits = _mm256_set1_epi8(static_cast<char>(0xE0));
+    const __m256i zeros = _mm256_setzero_si256();
+
+    size_t block_begin = 0;
+
+    for (; block_begin + kBlockSize <= text.size(); block_begin += kBlockSize) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + block_begin));
+
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(block, high_bits), zeros)) != 0) {
+            return false;
+        }
+
+        const auto space_mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, spaces)));
+        scanner.Consume(block_begin, kBlockSize, space_mask);
+    }
+
+    return ScanScalar(text, block_begin, scanner);
+} // ScanAvx2
+
+#endif
+
+template <typename Words>
+bool SplitIntoValidWordsImpl(std::string_view text, Words& words) {
+    words.clear();
+
+    WordScanner<Words> scanner(text, words);
+
+#ifdef HAS_X86_KERNELS
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+
+    const bool is_valid = has_avx2 ? ScanAvx2(text, scanner) : ScanSse2(text, scanner);
+#else
+    const bool is_valid = ScanScalar(text, 0, scanner);
+#endif
+
+    if (is_valid) {
+        scanner.Finish();
+    }
+
+    return is_valid;
+} // SplitIntoValidWordsImpl
+
+} // namespace
+
 std::vector<std::string> SplitIntoWords(const std::string& text) {
     std::istringstream text_stream(text);
     
@@ -20,18 +172,30 @@ std::vector<std::string> SplitIntoWords(const std::string& text) {
 std::vector<std::string_view> SplitIntoWords(std::string_view text) {
     std::vector<std::string_view> output;
 
-    while (true) {
-        size_t space_index = text.find(' ');
-        output.push_back(text.substr(0, space_index));
+    while (!text.empty()) {
+        const size_t word_begin = text.find_first_not_of(' ');
 
-        if (space_index == text.npos) {
+        if (word_begin == text.npos) {
             break;
-        } else {
-            text.remove_prefix(space_index + 1);
         }
+
+        text.remove_prefix(word_begin);
+
+        const size_t space_index = text.find(' ');
+        output.push_back(text.substr(0, space_index));
+
+        text.remove_prefix(space_index == text.npos ? text.size() : space_index);
     }
 
     return output;
 }
 
+bool SplitIntoValidWords(std::string_view text, std::vector<std::string_view>& words) {
+    return SplitIntoValidWordsImpl(text, words);
+}
+
+bool SplitIntoValidWords(std::string_view text, std::pmr::vector<std::string_view>& words) {
+    return SplitIntoValidWordsImpl(text, words);
+}
+
 } // string_processing
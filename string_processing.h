@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory_resource>
 #include <vector>
 #include <string>
 #include <string_view>
@@ -8,8 +9,15 @@ namespace string_processing {
 
 std::vector<std::string> SplitIntoWords(const std::string& text);
 
+// words separated by spaces, without empty ones
 std::vector<std::string_view> SplitIntoWords(std::string_view text);
 
+// Views of the words separated by spaces, found in the same scan that checks the text for
+// control bytes below 0x20. Returns false if there are any, the words are not complete then.
+[[nodiscard]] bool SplitIntoValidWords(std::string_view text, std::vector<std::string_view>& words);
+
+[[nodiscard]] bool SplitIntoValidWords(std::string_view text, std::pmr::vector<std::string_view>& words);
+
 }
 
 
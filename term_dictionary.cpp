@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "term_dictionary.h"
+
+TermDictionary::TermDictionary(const TermDictionary& other)
+    : chunks_(other.chunks_),
+      allocated_bytes_(other.allocated_bytes_),
+      id_to_term_(other.id_to_term_),
+      slots_(other.slots_) {
+    // the tail of the last chunk stays owned by other
+}
+
+TermDictionary& TermDictionary::operator=(const TermDictionary& other) {
+    if (this != &other) {
+        TermDictionary copy(other);
+        *this = std::move(copy);
+    }
+
+    return *this;
+}
+
+TermId TermDictionary::Intern(std::string_view term) {
+    const std::uint32_t hash = Hash(term);
+
+    if (!slots_.empty()) {
+        const auto [index, is_found] = Locate(term, hash);
+
+        if (is_found) {
+            return slots_[index].term_id;
+        }
+    }
+
+    if ((id_to_term_.size() + 1) * 100 > slots_.size() * kMaxLoadPercent) {
+        Rehash(std::max<size_t>(16, slots_.size() * 2));
+    }
+
+    const TermId term_id = static_cast<TermId>(id_to_term_.size());
+
+    id_to_term_.push_back(Store(term));
+    Place(Slot{hash, term_id});
+
+    return term_id;
+} // Intern
+
+std::optional<TermId> TermDictionary::Find(std::string_view term) const {
+    if (slots_.empty()) {
+        return std::nullopt;
+    }
+
+    const auto [index, is_found] = Locate(term, Hash(term));
+
+    if (is_found) {
+        return slots_[index].term_id;
+    }
+
+    return std::nullopt;
+} // Find
+
+std::string_view TermDictionary::GetTerm(TermId term_id) const {
+    assert(term_id < id_to_term_.size());
+
+    return id_to_term_[term_id];
+}
+
+size_t TermDictionary::GetTermCount() const {
+    return id_to_term_.size();
+}
+
+size_t TermDictionary::GetMemoryUsage() const {
+    return allocated_bytes_
+        + chunks_.capacity() * sizeof(std::shared_ptr<char[]>)
+        + id_to_term_.capacity() * sizeof(std::string_view)
+        + slots_.capacity() * sizeof(Slot);
+}
+
+std::string_view TermDictionary::Store(std::string_view term) {
+    if (term.empty()) {
+        return {};
+    }
+
+    if (term.size() > kChunkSize) {
+        std::shared_ptr<char[]> oversized_chunk(new char[term.size()]);
+        std::memcpy(oversized_chunk.get(), term.data(), term.size());
+
+        allocated_bytes_ += term.size();
+        chunks_.push_back(std::move(oversized_chunk));
+        chunk_used_ = kChunkSize;
+
+        return {chunks_.back().get(), term.size()};
+    }
+
+    if (kChunkSize - chunk_used_ < term.size()) {
+        chunks_.emplace_back(new char[kChunkSize]);
+        allocated_bytes_ += kChunkSize;
+        chunk_used_ = 0;
+    }
+
+    char* destination = chunks_.back().get() + chunk_used_;
+    std::memcpy(destination, term.data(), term.size());
+    chunk_used_ += term.size();
+
+    return {destination, term.size()};
+} // Store
+
+std::uint32_t TermDictionary::Hash(std::string_view term) {
+    return static_cast<std::uint32_t>(std::hash<std::string_view>{}(term));
+}
+
+size_t TermDictionary::GetProbeDistance(std::uint32_t hash, size_t index) const {
+    return (index - hash) & (slots_.size() - 1);
+}
+
+std::pair<size_t, bool> TermDictionary::Locate(std::string_view term, std::uint32_t hash) const {
+    const size_t mask = slots_.size() - 1;
+
+    for (size_t index = hash & mask, distance = 0; ; index = (index + 1) & mask, ++distance) {
+        const Slot& slot = slots_[index];
+
+        // a term is never further from home than a richer one it would have displaced
+        if (slot.term_id == kEmptySlot || GetProbeDistance(slot.hash, index) < distance) {
+            return {index, false};
+        }
+
+        if (slot.hash == hash && id_to_term_[slot.term_id] == term) {
+            return {index, true};
+        }
+    }
+} // Locate
+
+void TermDictionary::Place(Slot slot) {
+    const size_t mask = slots_.size() - 1;
+
+    for (size_t index = slot.hash & mask, distance = 0; ; index = (index + 1) & mask, ++distance) {
+        Slot& resident = slots_[index];
+
+        if (resident.term_id == kEmptySlot) {
+            resident = slot;
+            return;
+        }
+
+        // the poorer slot takes the place and the resident continues the probe
+        const size_t resident_distance = GetProbeDistance(resident.hash, index);
+
+        if (resident_distance < distance) {
+            std::swap(resident, slot);
+            distance = resident_distance;
+        }
+    }
+} // Place
+
+void TermDictionary::Rehash(size_t capacity) {
+    std::vector<Slot> slots(capacity);
+    slots.swap(slots_);
+
+    for (const Slot& slot : slots) {
+        if (slot.term_id != kEmptySlot) {
+            Place(slot);
+        }
+    }
+} // Rehash
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using TermId = std::uint32_t;
+
+// Interns every distinct word once and hands out dense ids in insertion order.
+// Term bytes live in fixed-size chunks, so views returned by GetTerm stay valid
+// for the lifetime of the dictionary and of all its copies. Words are found through
+// a Robin Hood hash table whose slots keep the hash next to the id, so a probe
+// compares term bytes only when the hashes match.
+// The bytes are not front-coded: that needs the terms in sorted order, while ids
+// are handed out as documents arrive, so every new term would rewrite the block.
+// Each term is stored once without prefix sharing, which still removes the
+// per-document copies of the words.
+class TermDictionary {
+public:
+    TermDictionary() = default;
+
+    TermDictionary(const TermDictionary& other);
+
+    TermDictionary& operator=(const TermDictionary& other);
+
+    TermDictionary(TermDictionary&& other) = default;
+
+    TermDictionary& operator=(TermDictionary&& other) = default;
+
+public:
+    TermId Intern(std::string_view term);
+
+    std::optional<TermId> Find(std::string_view term) const;
+
+    std::string_view GetTerm(TermId term_id) const;
+
+    size_t GetTermCount() const;
+
+    size_t GetMemoryUsage() const;
+
+private:
+    static constexpr size_t kChunkSize = 64 * 1024;
+
+    static constexpr TermId kEmptySlot = std::numeric_limits<TermId>::max();
+
+    // the table grows past this share of taken slots
+    static constexpr size_t kMaxLoadPercent = 75;
+
+private:
+    struct Slot {
+        // low bits of the hash, the home slot is taken from them too
+        std::uint32_t hash = 0;
+        TermId term_id = kEmptySlot;
+    };
+
+private:
+    std::string_view Store(std::string_view term);
+
+    static std::uint32_t Hash(std::string_view term);
+
+    // distance from the home slot of the hash to the index
+    size_t GetProbeDistance(std::uint32_t hash, size_t index) const;
+
+    // the position of the term, or of the slot where the probe ended
+    std::pair<size_t, bool> Locate(std::string_view term, std::uint32_t hash) const;
+
+    // the term must be new
+    void Place(Slot slot);
+
+    void Rehash(size_t capacity);
+
+private:
+    // chunks are shared between copies and never written past chunk_used_
+    std::vector<std::shared_ptr<char[]>> chunks_;
+    size_t chunk_used_ = kChunkSize;
+    size_t allocated_bytes_ = 0;
+
+    std::vector<std::string_view> id_to_term_;
+
+    // capacity is a power of two
+    std::vector<Slot> slots_;
+};
@@ -1,12 +1,27 @@
 #include <vector>
 #include <cmath>
 #include <cassert>
+#include <random>
+#include <atomic>
+#include <thread>
 
 #include "test_search_server.h"
 #include "testing_framework.h"
 #include "search_server.h"
 #include "string_processing.h"
 #include "remove_duplicates.h"
+#include "sharded_search_server.h"
+#include "concurrent_search_server.h"
+#include "segmented_search_server.h"
+#include "term_dictionary.h"
+#include "posting_list.h"
+#include "posting_intersection.h"
+#include "compressed_posting_list.h"
+#include "document_columns.h"
+#include "exclusion_cache.h"
+#include "small_vector.h"
+#include "stop_word_filter.h"
+#include "quantization_report.h"
 
 void TestIteratingOverSearchServer() {
     SearchServer search_server;
@@ -41,9 +56,25 @@ void TestGetWordFrequencies() {
         
         const auto word_frequencies_of_not_existing_document = search_server.GetWordFrequencies(42);
         
-        std::map<std::string, double> empty_map;
+        assert(word_frequencies_of_not_existing_document.empty());
+        assert(word_frequencies_of_not_existing_document.count("cat"s) == 0);
+    }
+    
+    {
+        SearchServer search_server;
+        
+        search_server_helpers::AddDocument(search_server, 0, "funny funny cat"s, DocumentStatus::ACTUAL, {1, 2, 3});
+        
+        // iterators stay valid after the view they came from is gone
+        auto it = search_server.GetWordFrequencies(0).begin();
+        const auto end = search_server.GetWordFrequencies(0).end();
         
-        assert(empty_map == word_frequencies_of_not_existing_document);
+        std::map<std::string, double> word_frequencies;
+        for (; it != end; ++it) {
+            word_frequencies.emplace((*it).first, (*it).second);
+        }
+        
+        assert((word_frequencies == std::map<std::string, double>{{"funny"s, 2.0 / 3.0}, {"cat"s, 1.0 / 3.0}}));
     }
 }
 
@@ -64,6 +95,29 @@ void TestDeletingDocument() {
     assert(results.empty());
 }
 
+void TestArbitraryDocumentIds() {
+    SearchServer search_server;
+    
+    search_server.AddDocument(100, "funny cat"s, DocumentStatus::ACTUAL, {1});
+    search_server.AddDocument(5, "funny dog"s, DocumentStatus::ACTUAL, {2});
+    search_server.AddDocument(50, "sad cat"s, DocumentStatus::ACTUAL, {3});
+    
+    search_server.RemoveDocument(5);
+    search_server.AddDocument(5, "funny cat cat"s, DocumentStatus::ACTUAL, {4});
+    
+    const auto results = search_server.FindTopDocuments("funny cat"s);
+    
+    ASSERT_EQUAL(results.size(), 3u);
+    ASSERT_EQUAL(results[0].id, 100);
+    ASSERT_EQUAL(results[1].id, 5);
+    ASSERT_EQUAL(results[2].id, 50);
+    
+    const auto [words, status] = search_server.MatchDocument("funny dog"s, 5);
+    
+    ASSERT_EQUAL(words, std::vector<std::string>{"funny"s});
+    ASSERT_EQUAL(std::vector<int>(search_server.begin(), search_server.end()), (std::vector<int>{5, 50, 100}));
+}
+
 void TestRemoveDuplicates() {
     SearchServer search_server;
     
@@ -77,6 +131,1228 @@ void TestRemoveDuplicates() {
     assert(search_server.GetDocumentCount() == 3);
 }
 
+void TestTermDictionary() {
+    TermDictionary terms;
+    
+    const TermId cat = terms.Intern("cat"s);
+    const TermId dog = terms.Intern("dog"s);
+    
+    ASSERT_EQUAL(cat, 0u);
+    ASSERT_EQUAL(dog, 1u);
+    ASSERT_EQUAL(terms.Intern("cat"s), cat);
+    ASSERT_EQUAL(terms.GetTermCount(), 2u);
+    ASSERT_EQUAL(terms.GetTerm(dog), "dog"s);
+    ASSERT(terms.Find("dog"s) == dog);
+    ASSERT(!terms.Find("frog"s).has_value());
+    
+    // copies keep valid views and intern independently
+    TermDictionary copy = terms;
+    
+    ASSERT_EQUAL(copy.Intern("frog"s), 2u);
+    ASSERT_EQUAL(terms.Intern("bird"s), 2u);
+    ASSERT_EQUAL(copy.GetTerm(2), "frog"s);
+    ASSERT_EQUAL(terms.GetTerm(2), "bird"s);
+    ASSERT_EQUAL(copy.GetTerm(cat), "cat"s);
+    
+    // the hash table grows several times and keeps every id
+    for (int i = 0; i < 10'000; ++i) {
+        ASSERT_EQUAL(terms.Intern("w"s + std::to_string(i)), static_cast<TermId>(i + 3));
+    }
+    
+    for (int i = 0; i < 10'000; ++i) {
+        ASSERT(terms.Find("w"s + std::to_string(i)) == static_cast<TermId>(i + 3));
+        ASSERT(!terms.Find("x"s + std::to_string(i)).has_value());
+    }
+    
+    ASSERT(terms.Find(""s) == std::nullopt);
+    ASSERT_EQUAL(terms.Intern(""s), 10'003u);
+    ASSERT(terms.Find(""s) == 10'003u);
+}
+
+void TestPostingList() {
+    PostingList postings;
+    
+    postings.Add(1, 0.5);
+    postings.Add(7, 0.25);
+    postings.Add(3, 1.0);
+    
+    ASSERT_EQUAL(postings.GetDocumentIds(), (std::vector<int>{1, 3, 7}));
+    ASSERT_EQUAL(postings.GetTermFrequencies(), (std::vector<double>{0.5, 1.0, 0.25}));
+    ASSERT(postings.Contains(3));
+    ASSERT_EQUAL(postings.GetMaxTermFrequency(), 1.0);
+    
+    ASSERT(postings.Remove(3));
+    ASSERT(!postings.Remove(3));
+    ASSERT(!postings.Contains(3));
+    ASSERT_EQUAL(postings.GetDocumentIds(), (std::vector<int>{1, 7}));
+    ASSERT_EQUAL(postings.GetTermFrequencies(), (std::vector<double>{0.5, 0.25}));
+    
+    // removing the maximum lowers it
+    ASSERT_EQUAL(postings.GetMaxTermFrequency(), 0.5);
+}
+
+void TestCompressedPostingList() {
+    PostingList postings;
+    
+    for (int document_id = 0; document_id < 1000; document_id += 1 + document_id % 7) {
+        postings.Add(document_id, 1.0 / (1 + document_id % 5));
+    }
+    postings.Add(1'000'000, 0.5);
+    
+    const CompressedPostingList compressed_postings(postings);
+    
+    ASSERT_EQUAL(compressed_postings.size(), postings.size());
+    ASSERT_EQUAL(compressed_postings.GetMaxTermFrequency(), postings.GetMaxTermFrequency());
+    ASSERT(compressed_postings.GetMemoryUsage() < postings.GetMemoryUsage());
+    
+    const PostingList decoded_postings = compressed_postings.Decode();
+    
+    ASSERT_EQUAL(decoded_postings.GetDocumentIds(), postings.GetDocumentIds());
+    
+    for (size_t i = 0; i < postings.size(); ++i) {
+        ASSERT(std::abs(decoded_postings.GetTermFrequencies()[i] - postings.GetTermFrequencies()[i]) < 1e-4);
+    }
+    
+    const CompressedPostingList byte_postings(postings, Quantization::uint8);
+    
+    ASSERT(byte_postings.GetQuantization() == Quantization::uint8);
+    ASSERT(byte_postings.GetMemoryUsage() < compressed_postings.GetMemoryUsage());
+    
+    const PostingList byte_decoded_postings = byte_postings.Decode();
+    
+    ASSERT_EQUAL(byte_decoded_postings.GetDocumentIds(), postings.GetDocumentIds());
+    
+    // half a step of 255 levels of the block maximum, which is 1 here
+    for (size_t i = 0; i < postings.size(); ++i) {
+        ASSERT(std::abs(byte_decoded_postings.GetTermFrequencies()[i] - postings.GetTermFrequencies()[i]) <= 0.5 / 255.0 + 1e-12);
+    }
+}
+
+void TestCompressedPostingsSearch() {
+    SearchServer search_server;
+    
+    search_server.AddDocument(0, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, {1});
+    search_server.AddDocument(1, "funny pet with curly hair"s, DocumentStatus::ACTUAL, {2});
+    search_server.AddDocument(2, "nasty rat with curly hair"s, DocumentStatus::ACTUAL, {3});
+    
+    const auto plain_results = search_server.FindTopDocuments("curly funny -nasty"s);
+    
+    search_server.CompressPostings();
+    
+    const auto compressed_results = search_server.FindTopDocuments("curly funny -nasty"s);
+    
+    ASSERT_EQUAL(compressed_results.size(), plain_results.size());
+    ASSERT_EQUAL(compressed_results[0].id, plain_results[0].id);
+    ASSERT(std::abs(compressed_results[0].relevance - plain_results[0].relevance) < 1e-4);
+    
+    // writes still work on compressed terms
+    search_server.RemoveDocument(1);
+    search_server.AddDocument(3, "curly dog"s, DocumentStatus::ACTUAL, {4});
+    
+    const auto results = search_server.FindTopDocuments("curly"s);
+    
+    ASSERT_EQUAL(results.size(), 2u);
+    ASSERT_EQUAL(results[0].id, 3);
+}
+
+template <typename Server>
+void AddRandomDocuments(Server& search_server, int document_count, int vocabulary_size) {
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<int> word_distribution(0, vocabulary_size - 1);
+    std::uniform_int_distribution<int> length_distribution(1, 12);
+    std::uniform_int_distribution<int> rating_distribution(-3, 3);
+    
+    for (int document_id = 0; document_id < document_count; ++document_id) {
+        std::string document;
+        
+        for (int i = length_distribution(generator); i > 0; --i) {
+            // squaring makes low word numbers much more frequent
+            const int word = word_distribution(generator) * word_distribution(generator) / vocabulary_size;
+            document += "w"s + std::to_string(word) + " "s;
+        }
+        
+        search_server.AddDocument(document_id * 3, document,
+                                  document_id % 5 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL,
+                                  {rating_distribution(generator)});
+    }
+}
+
+SearchServer CreateRandomSearchServer(int document_count, int vocabulary_size) {
+    SearchServer search_server;
+    
+    AddRandomDocuments(search_server, document_count, vocabulary_size);
+    
+    return search_server;
+}
+
+void AssertSameDocuments(const std::vector<Document>& left, const std::vector<Document>& right) {
+    ASSERT_EQUAL(left.size(), right.size());
+    
+    for (size_t i = 0; i < left.size(); ++i) {
+        ASSERT_EQUAL(left[i].id, right[i].id);
+        ASSERT_EQUAL(left[i].rating, right[i].rating);
+        ASSERT(std::abs(left[i].relevance - right[i].relevance) < 1e-9);
+    }
+}
+
+void TestQuantizationReport() {
+    const SearchServer search_server = CreateRandomSearchServer(2000, 40);
+    
+    std::vector<std::string> queries;
+    for (int word = 0; word < 40; ++word) {
+        queries.push_back("w"s + std::to_string(word) + " w"s + std::to_string(39 - word));
+    }
+    
+    const QuantizationReport word_report = MeasureQuantization(search_server, queries, Quantization::uint16, 10);
+    const QuantizationReport byte_report = MeasureQuantization(search_server, queries, Quantization::uint8, 10);
+    
+    ASSERT_EQUAL(word_report.query_count, queries.size());
+    ASSERT(word_report.changed_top_count + word_report.reordered_top_count <= queries.size());
+    ASSERT(word_report.max_relevance_error < 1e-3);
+    ASSERT(word_report.max_relevance_error <= byte_report.max_relevance_error);
+    ASSERT(byte_report.max_relevance_error > 0.0);
+}
+
+void TestDynamicPruningMatchesExhaustive() {
+    SearchServer search_server = CreateRandomSearchServer(5000, 60);
+    
+    const std::vector<std::string> queries = {
+        "w0"s, "w1 w2"s, "w0 w1 w2 w3"s, "w5 w40 w59"s, "w1 w30 -w0"s, "w2 w3 w4 w5 w6 w7 -w1 -w9"s, "nothing"s, "w58 w59"s
+    };
+    
+    const auto even_rating = [](int , DocumentStatus , int rating) {
+        return rating % 2 == 0;
+    };
+    
+    for (int round = 0; round < 2; ++round) {
+        for (const Evaluation evaluation : {Evaluation::block_max_wand, Evaluation::max_score}) {
+            SearchOptions options;
+            options.evaluation = evaluation;
+            
+            for (const std::string& query : queries) {
+                AssertSameDocuments(search_server.FindTopDocuments(options, query),
+                                    search_server.FindTopDocuments(query));
+                AssertSameDocuments(search_server.FindTopDocuments(options, query, DocumentStatus::BANNED),
+                                    search_server.FindTopDocuments(query, DocumentStatus::BANNED));
+                AssertSameDocuments(search_server.FindTopDocuments(options, query, even_rating),
+                                    search_server.FindTopDocuments(query, even_rating));
+            }
+        }
+        
+        search_server.CompressPostings();
+    }
+    
+    // these collections skip blocks right before a document of the next cursor
+    for (const int vocabulary_size : {30, 70, 75}) {
+        const SearchServer skipping_search_server = CreateRandomSearchServer(3000, vocabulary_size);
+        
+        for (const int max_result_document_count : {5, 10, 20}) {
+            SearchOptions options;
+            options.max_result_document_count = max_result_document_count;
+            
+            for (const std::string& query : {"w1 w2"s, "w10 w20 w49"s, "w2 w3 w4 w5 w6 w7 -w1 -w9"s}) {
+                options.evaluation = Evaluation::exhaustive;
+                const auto exhaustive_documents = skipping_search_server.FindTopDocuments(options, query);
+                
+                options.evaluation = Evaluation::block_max_wand;
+                AssertSameDocuments(skipping_search_server.FindTopDocuments(options, query), exhaustive_documents);
+            }
+        }
+    }
+}
+
+void TestAddDocuments() {
+    const SearchServer search_server = CreateRandomSearchServer(3000, 50);
+    
+    std::vector<NewDocument> documents;
+    
+    for (const int document_id : search_server) {
+        std::string text;
+        
+        // extra spaces must not make empty words
+        for (const auto& [word, term_frequency] : search_server.GetWordFrequencies(document_id)) {
+            text += " "s + std::string(word) + " "s;
+        }
+        
+        documents.push_back({document_id, text, DocumentStatus::ACTUAL, {1}});
+    }
+    
+    SearchServer added_search_server;
+    
+    for (const NewDocument& document : documents) {
+        added_search_server.AddDocument(document.id, document.text, document.status, document.ratings);
+    }
+    
+    for (const Policy policy : {Policy::sequential, Policy::parallel}) {
+        SearchServer batch_search_server;
+        batch_search_server.AddDocuments(documents, policy);
+        
+        ASSERT_EQUAL(batch_search_server.GetDocumentCount(), search_server.GetDocumentCount());
+        
+        for (const std::string& word : {"w0"s, "w7"s, "w49"s}) {
+            ASSERT_EQUAL(batch_search_server.GetDocumentFrequency(word), search_server.GetDocumentFrequency(word));
+        }
+        
+        for (const int document_id : {0, 3, 4497, 8997}) {
+            const WordFrequencies batch_word_frequencies = batch_search_server.GetWordFrequencies(document_id);
+            
+            ASSERT_EQUAL(batch_word_frequencies.size(), search_server.GetWordFrequencies(document_id).size());
+            
+            // postings of every chunk are merged after the ones of earlier chunks
+            for (const auto& [word, term_frequency] : batch_word_frequencies) {
+                ASSERT_EQUAL(std::get<0>(batch_search_server.MatchDocument(word, document_id)).size(), 1u);
+            }
+        }
+        
+        AssertSameDocuments(batch_search_server.FindTopDocuments("w0 w7 -w49"s), added_search_server.FindTopDocuments("w0 w7 -w49"s));
+    }
+    
+    SearchServer batch_search_server("and"s);
+    
+    batch_search_server.AddDocuments({
+        {1, "funny  pet and rat"s, DocumentStatus::ACTUAL, {1, 2, 3}},
+        {2, "pet with rat and rat"s, DocumentStatus::BANNED, {4}},
+    }, Policy::parallel);
+    
+    SearchServer single_search_server("and"s);
+    single_search_server.AddDocument(1, "funny  pet and rat"s, DocumentStatus::ACTUAL, {1, 2, 3});
+    single_search_server.AddDocument(2, "pet with rat and rat"s, DocumentStatus::BANNED, {4});
+    
+    AssertSameDocuments(batch_search_server.FindTopDocuments("funny rat"s), single_search_server.FindTopDocuments("funny rat"s));
+    AssertSameDocuments(batch_search_server.FindTopDocuments("rat"s, DocumentStatus::BANNED),
+                        single_search_server.FindTopDocuments("rat"s, DocumentStatus::BANNED));
+    ASSERT_EQUAL(batch_search_server.GetWordFrequencies(2).at("rat"s), 0.5);
+    
+    // a rejected batch adds nothing
+    try {
+        batch_search_server.AddDocuments({{3, "new pet"s, DocumentStatus::ACTUAL, {1}}, {1, "repeating id"s, DocumentStatus::ACTUAL, {1}}});
+        ASSERT_HINT(false, "repeating ids must throw"s);
+    } catch (const std::invalid_argument&) {
+    }
+    
+    ASSERT_EQUAL(batch_search_server.GetDocumentCount(), 2);
+    ASSERT(batch_search_server.FindTopDocuments("new"s).empty());
+}
+
+void TestInverseDocumentFrequencyCache() {
+    SearchServer search_server;
+    
+    search_server.AddDocument(0, "white cat"s, DocumentStatus::ACTUAL, {1});
+    search_server.AddDocument(1, "black dog"s, DocumentStatus::ACTUAL, {1});
+    
+    const double relevance = search_server.FindTopDocuments("cat"s)[0].relevance;
+    ASSERT(std::abs(relevance - std::log(2.0) / 2.0) < 1e-9);
+    
+    // cached frequencies follow document counts
+    search_server.AddDocument(2, "black bird"s, DocumentStatus::ACTUAL, {1});
+    ASSERT(std::abs(search_server.FindTopDocuments("cat"s)[0].relevance - std::log(3.0) / 2.0) < 1e-9);
+    
+    search_server.RemoveDocument(1);
+    ASSERT(std::abs(search_server.FindTopDocuments("black"s)[0].relevance - std::log(2.0) / 2.0) < 1e-9);
+    
+    // copies keep their own cache
+    SearchServer copied_search_server = search_server;
+    copied_search_server.AddDocument(3, "grey cat"s, DocumentStatus::ACTUAL, {1});
+    ASSERT(std::abs(copied_search_server.FindTopDocuments("white"s)[0].relevance - std::log(3.0) / 2.0) < 1e-9);
+    ASSERT(std::abs(search_server.FindTopDocuments("white"s)[0].relevance - std::log(2.0) / 2.0) < 1e-9);
+    
+    search_server.FreezeStatistics();
+    
+    search_server.AddDocument(4, "red fox"s, DocumentStatus::ACTUAL, {1});
+    search_server.AddDocument(5, "blue fox"s, DocumentStatus::ACTUAL, {1});
+    ASSERT(std::abs(search_server.FindTopDocuments("white"s)[0].relevance - std::log(2.0) / 2.0) < 1e-9);
+    
+    search_server.RefreshStatistics();
+    ASSERT(std::abs(search_server.FindTopDocuments("white"s)[0].relevance - std::log(4.0) / 2.0) < 1e-9);
+    
+    search_server.UnfreezeStatistics();
+    search_server.AddDocument(6, "green frog"s, DocumentStatus::ACTUAL, {1});
+    ASSERT(std::abs(search_server.FindTopDocuments("white"s)[0].relevance - std::log(5.0) / 2.0) < 1e-9);
+}
+
+void TestTombstoneRemoval() {
+    for (const bool is_compressed : {false, true}) {
+        SearchServer search_server = CreateRandomSearchServer(2000, 40);
+        SearchServer eager_search_server = search_server;
+        
+        if (is_compressed) {
+            search_server.CompressPostings();
+        }
+        
+        search_server.SetMaxDeletedRatio(1.0);
+        eager_search_server.SetMaxDeletedRatio(0.0);
+        
+        for (int document_id = 0; document_id < 6000; document_id += 9) {
+            search_server.RemoveDocument(document_id);
+            eager_search_server.RemoveDocument(document_id, Policy::parallel);
+        }
+        
+        ASSERT_EQUAL(search_server.GetDeletedDocumentCount(), 667u);
+        ASSERT_EQUAL(eager_search_server.GetDeletedDocumentCount(), 0u);
+        ASSERT_EQUAL(search_server.GetDocumentCount(), eager_search_server.GetDocumentCount());
+        ASSERT_EQUAL(search_server.GetDocumentFrequency("w0"s), eager_search_server.GetDocumentFrequency("w0"s));
+        
+        for (int round = 0; round < 2; ++round) {
+            for (const Evaluation evaluation : {Evaluation::exhaustive, Evaluation::block_max_wand, Evaluation::max_score}) {
+                SearchOptions options;
+                options.evaluation = evaluation;
+                options.max_result_document_count = 50;
+                
+                for (const std::string& query : {"w0"s, "w1 w2 w3 -w0"s, "w10 w20 w39"s}) {
+                    const auto documents = search_server.FindTopDocuments(options, query);
+                    const auto eager_documents = eager_search_server.FindTopDocuments(options, query);
+                    
+                    ASSERT_EQUAL(documents.size(), eager_documents.size());
+                    
+                    for (size_t i = 0; i < documents.size(); ++i) {
+                        ASSERT(documents[i].id % 9 != 0);
+                        ASSERT(std::abs(documents[i].relevance - eager_documents[i].relevance) < 1e-4);
+                    }
+                }
+            }
+            
+            search_server.CompactPostings();
+            ASSERT_EQUAL(search_server.GetDeletedDocumentCount(), 0u);
+        }
+    }
+    
+    SearchServer search_server = CreateRandomSearchServer(100, 10);
+    
+    // the fifth removal crosses the ratio
+    search_server.SetMaxDeletedRatio(0.04);
+    
+    for (int document_id = 0; document_id < 12; document_id += 3) {
+        search_server.RemoveDocument(document_id);
+    }
+    
+    ASSERT_EQUAL(search_server.GetDeletedDocumentCount(), 4u);
+    
+    search_server.RemoveDocument(12);
+    ASSERT_EQUAL(search_server.GetDeletedDocumentCount(), 0u);
+    
+    try {
+        search_server.SetMaxDeletedRatio(1.5);
+        ASSERT_HINT(false, "deleted ratio above 1 must throw"s);
+    } catch (const std::invalid_argument&) {
+    }
+    
+    // compaction renumbers the live documents, results must not change
+    SearchServer renumbered_search_server = CreateRandomSearchServer(2000, 40);
+    renumbered_search_server.SetMaxDeletedRatio(1.0);
+    
+    for (int document_id = 0; document_id < 6000; document_id += 6) {
+        renumbered_search_server.RemoveDocument(document_id);
+    }
+    
+    const std::vector<std::string> queries = {"w0"s, "w1 w2 -w0"s, "w10 w20 -w3"s};
+    std::vector<std::vector<Document>> expected_documents;
+    
+    // minus words get cached bitmaps, which compaction must drop
+    for (int round = 0; round < 4; ++round) {
+        expected_documents.clear();
+        
+        for (const std::string& query : queries) {
+            expected_documents.push_back(renumbered_search_server.FindTopDocuments(query));
+            expected_documents.push_back(renumbered_search_server.FindTopDocuments(query, DocumentStatus::BANNED));
+        }
+    }
+    
+    const MemoryReport uncompacted_report = renumbered_search_server.GetMemoryReport();
+    renumbered_search_server.CompactPostings();
+    const MemoryReport compacted_report = renumbered_search_server.GetMemoryReport();
+    
+    ASSERT(compacted_report.document_column_bytes < uncompacted_report.document_column_bytes);
+    ASSERT(compacted_report.forward_index_bytes < uncompacted_report.forward_index_bytes);
+    
+    for (size_t i = 0; i < queries.size(); ++i) {
+        AssertSameDocuments(renumbered_search_server.FindTopDocuments(queries[i]), expected_documents[2 * i]);
+        AssertSameDocuments(renumbered_search_server.FindTopDocuments(queries[i], DocumentStatus::BANNED), expected_documents[2 * i + 1]);
+    }
+    
+    renumbered_search_server.SetDocumentStatus(3, DocumentStatus::IRRELEVANT);
+    ASSERT(std::get<1>(renumbered_search_server.MatchDocument("w0"s, 3)) == DocumentStatus::IRRELEVANT);
+    
+    // new documents go after the live ones
+    renumbered_search_server.AddDocument(6001, "w0 w0"s, DocumentStatus::ACTUAL, {5});
+    ASSERT_EQUAL(renumbered_search_server.FindTopDocuments("w0"s)[0].id, 6001);
+    ASSERT_EQUAL(renumbered_search_server.GetWordFrequencies(6001).at("w0"s), 1.0);
+}
+
+void TestForwardIndex() {
+    SearchServer search_server;
+    
+    search_server.AddDocument(1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, {1});
+    search_server.AddDocument(2, "funny pet with curly hair"s, DocumentStatus::ACTUAL, {1});
+    search_server.AddDocument(3, "big cat nasty hair"s, DocumentStatus::ACTUAL, {1});
+    
+    // words come in term id order, which is the order they were first indexed in
+    std::vector<std::string> words;
+    for (const auto& [word, term_frequency] : search_server.GetWordFrequencies(3)) {
+        words.emplace_back(word);
+        ASSERT_EQUAL(term_frequency, 0.25);
+    }
+    
+    ASSERT_EQUAL(words, (std::vector<std::string>{"nasty"s, "hair"s, "big"s, "cat"s}));
+    ASSERT_EQUAL(search_server.GetWordFrequencies(2).count("rat"s), 0u);
+    ASSERT_EQUAL(search_server.GetWordFrequencies(2).count("curly"s), 1u);
+    
+    try {
+        search_server.GetWordFrequencies(2).at("unknown"s);
+        ASSERT_HINT(false, "missing words must throw"s);
+    } catch (const std::out_of_range&) {
+    }
+    
+    search_server.SetMaxDeletedRatio(1.0);
+    search_server.RemoveDocument(1);
+    ASSERT(search_server.GetWordFrequencies(1).empty());
+    
+    // compaction moves the remaining documents over the removed one
+    search_server.CompactPostings();
+    
+    ASSERT_EQUAL(search_server.GetWordFrequencies(2).size(), 5u);
+    ASSERT_EQUAL(search_server.GetWordFrequencies(3).at("cat"s), 0.25);
+    ASSERT_EQUAL(std::get<0>(search_server.MatchDocument("nasty cat"s, 3)), (std::vector<std::string>{"cat"s, "nasty"s}));
+    ASSERT(std::get<0>(search_server.MatchDocument("nasty cat -curly"s, 2)).empty());
+    
+    SearchServer merged_search_server;
+    merged_search_server.AddDocument(4, "hair of a cat"s, DocumentStatus::ACTUAL, {1});
+    merged_search_server.MergeFrom(search_server);
+    
+    ASSERT_EQUAL(merged_search_server.GetWordFrequencies(3).size(), 4u);
+    ASSERT_EQUAL(merged_search_server.GetWordFrequencies(2).at("funny"s), 0.2);
+    
+    ASSERT(search_server.GetMemoryReport().forward_index_bytes > 0);
+}
+
+void TestQueryArena() {
+    SearchServer search_server;
+    
+    search_server.AddDocument(1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, {1});
+    search_server.AddDocument(2, "funny pet with curly hair"s, DocumentStatus::ACTUAL, {2});
+    
+    const auto documents = search_server.FindTopDocuments("funny -curly"s);
+    
+    // a query that does not fit the buffer takes the rest from the heap and the buffer grows after it
+    const size_t capacity = QueryArena::GetThreadArena().GetCapacity();
+    
+    std::string long_query = "funny -curly"s;
+    for (size_t i = 0; long_query.size() < 2 * capacity; ++i) {
+        long_query += " word"s + std::to_string(i);
+    }
+    
+    ASSERT_EQUAL(search_server.FindTopDocuments(long_query).size(), 1u);
+    ASSERT(QueryArena::GetThreadArena().GetCapacity() > capacity);
+    
+    const auto documents_after_growth = search_server.FindTopDocuments("funny -curly"s);
+    
+    ASSERT_EQUAL(documents_after_growth.size(), documents.size());
+    ASSERT_EQUAL(documents_after_growth[0].id, documents[0].id);
+    ASSERT_EQUAL(std::get<0>(search_server.MatchDocument("curly hair -rat"s, 2)), (std::vector<std::string>{"curly"s, "hair"s}));
+    
+}
+
+void TestLongQueryParsing() {
+    const SearchServer search_server = CreateRandomSearchServer(2000, 40);
+    
+    // repeating words, words missing from the index and minus words, longer than the inline capacity of a query
+    std::string long_query;
+    for (int i = 0; i < 1000; ++i) {
+        long_query += "w"s + std::to_string(i % 60) + " "s;
+    }
+    long_query += "-w3 -w7 -w3"s;
+    
+    SearchOptions options;
+    options.max_result_document_count = 100;
+    
+    SearchOptions parallel_options = options;
+    parallel_options.parse_policy = Policy::parallel;
+    
+    AssertSameDocuments(search_server.FindTopDocuments(parallel_options, long_query),
+                        search_server.FindTopDocuments(options, long_query));
+    
+    const int document_id = *search_server.begin();
+    ASSERT_EQUAL(std::get<0>(search_server.MatchDocument(long_query, document_id, Policy::parallel)),
+                 std::get<0>(search_server.MatchDocument(long_query, document_id)));
+    
+    try {
+        search_server.FindTopDocuments(parallel_options, long_query + " --w1"s);
+        ASSERT_HINT(false, "double minus must throw"s);
+    } catch (const std::invalid_argument&) {
+    }
+    
+    SmallVector<int, 4> small_vector(std::pmr::new_delete_resource());
+    for (const int value : {5, 1, 5, 3, 1, 2, 9}) {
+        small_vector.push_back(value);
+    }
+    small_vector.SortAndDeduplicate();
+    
+    ASSERT_EQUAL(std::vector<int>(small_vector.begin(), small_vector.end()), (std::vector<int>{1, 2, 3, 5, 9}));
+    small_vector.resize(2);
+    ASSERT_EQUAL(std::vector<int>(small_vector.begin(), small_vector.end()), (std::vector<int>{1, 2}));
+}
+
+void TestExclusionBitmaps() {
+    SearchServer search_server = CreateRandomSearchServer(5000, 40);
+    
+    // w0 is in most documents, w39 in few
+    const std::string query = "w1 w2 w5 -w0 -w39"s;
+    
+    SearchOptions options;
+    options.max_result_document_count = 50;
+    
+    const std::vector<Document> expected_documents = search_server.FindTopDocuments(options, query);
+    ASSERT_EQUAL(search_server.GetMemoryReport().exclusion_bitmap_bytes, 0u);
+    
+    for (int round = 0; round < 3; ++round) {
+        for (const Evaluation evaluation : {Evaluation::exhaustive, Evaluation::block_max_wand, Evaluation::max_score}) {
+            options.evaluation = evaluation;
+            
+            AssertSameDocuments(search_server.FindTopDocuments(options, query), expected_documents);
+        }
+    }
+    
+    ASSERT(search_server.GetMemoryReport().exclusion_bitmap_bytes > 0);
+    
+    // the bitmap does not cover the new document, so it is rebuilt
+    search_server.AddDocument(1'000'000, "w1 w2 w5 w0"s, DocumentStatus::ACTUAL, {100});
+    
+    for (const Evaluation evaluation : {Evaluation::exhaustive, Evaluation::block_max_wand, Evaluation::max_score}) {
+        options.evaluation = evaluation;
+        
+        for (const Document& document : search_server.FindTopDocuments(options, query)) {
+            ASSERT(document.id != 1'000'000);
+        }
+    }
+    
+    const SearchServer copy = search_server;
+    ASSERT_EQUAL(copy.GetMemoryReport().exclusion_bitmap_bytes, search_server.GetMemoryReport().exclusion_bitmap_bytes);
+}
+
+void TestExclusionCache() {
+    ExclusionCache cache;
+    std::vector<int> build_starts;
+    
+    const auto build = [&build_starts](DocumentBitmap& bitmap, int first_document_index) {
+        build_starts.push_back(first_document_index);
+        
+        for (int document_index = first_document_index; document_index < static_cast<int>(bitmap.size()); document_index += 2) {
+            bitmap.Set(document_index);
+        }
+    };
+    
+    ASSERT(cache.Get(7, 100, build) == nullptr);
+    ASSERT(cache.Get(7, 100, build) == nullptr);
+    
+    const auto bitmap = cache.Get(7, 100, build);
+    ASSERT(bitmap != nullptr);
+    ASSERT_EQUAL(bitmap->Count(), 50u);
+    ASSERT(cache.Get(7, 100, build) == bitmap);
+    
+    // documents appended since are added to a copy, the bitmap held by a query does not change
+    const auto extended_bitmap = cache.Get(7, 150, build);
+    ASSERT_EQUAL(extended_bitmap->size(), 150u);
+    ASSERT_EQUAL(extended_bitmap->Count(), 75u);
+    ASSERT_EQUAL(bitmap->size(), 100u);
+    ASSERT_EQUAL(build_starts, (std::vector<int>{0, 100}));
+    
+    // every slot taken by terms used as often as term 7
+    for (TermId term_id = 100; term_id < 163; ++term_id) {
+        for (int i = 0; i < 4; ++i) {
+            cache.Get(term_id, 150, build);
+        }
+        ASSERT(cache.Get(term_id, 150, build) != nullptr);
+    }
+    
+    // a term used more than the least used one takes its slot
+    for (int i = 0; i < 3; ++i) {
+        ASSERT(cache.Get(1000, 150, build) == nullptr);
+    }
+    for (int i = 0; i < 4; ++i) {
+        cache.Get(1000, 150, build);
+    }
+    ASSERT(cache.Get(1000, 150, build) != nullptr);
+    
+    const ExclusionCache copy = cache;
+    ASSERT_EQUAL(copy.GetMemoryUsage(), cache.GetMemoryUsage());
+}
+
+void TestIntersectionKernels() {
+    std::mt19937 generator(7);
+    
+    const auto generate_ids = [&generator](size_t count, int max_id) {
+        std::uniform_int_distribution<int> distribution(0, max_id);
+        
+        std::vector<int> ids(count);
+        for (int& id : ids) {
+            id = distribution(generator);
+        }
+        
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        
+        return ids;
+    };
+    
+    for (const auto& [left_size, right_size] : std::vector<std::pair<size_t, size_t>>{{0, 10}, {3, 5}, {100, 100}, {1000, 37}, {20, 5000}}) {
+        const std::vector<int> left = generate_ids(left_size, 3000);
+        const std::vector<int> right = generate_ids(right_size, 3000);
+        
+        std::vector<int> expected;
+        std::set_intersection(left.begin(), left.end(), right.begin(), right.end(), std::back_inserter(expected));
+        
+        for (const IntersectionKernel kernel : {IntersectionKernel::scalar, IntersectionKernel::galloping,
+                                                IntersectionKernel::sse, IntersectionKernel::avx2}) {
+            if (!IsSupported(kernel)) {
+                continue;
+            }
+            
+            // in place, like a query narrows down its shortest list
+            std::vector<int> output = left;
+            output.resize(IntersectDocumentIds(kernel, output.data(), output.size(), right.data(), right.size(), output.data()));
+            
+            ASSERT_EQUAL(output, expected);
+        }
+    }
+}
+
+void TestConjunctiveMatching() {
+    SearchServer search_server = CreateRandomSearchServer(5000, 40);
+    
+    const std::vector<std::string> queries = {
+        "w0"s, "w0 w1"s, "w1 w2 w3"s, "w0 w5 -w1"s, "w2 w30 w39"s, "w0 w1 nothing"s, "w3 w3 w4"s
+    };
+    
+    SearchOptions options;
+    options.max_result_document_count = 10'000;
+    
+    SearchOptions conjunctive_options = options;
+    conjunctive_options.matching = Matching::all;
+    
+    for (int round = 0; round < 2; ++round) {
+        for (const std::string& query : queries) {
+            std::set<std::string> plus_words;
+            for (const std::string& word : string_processing::SplitIntoWords(query)) {
+                plus_words.insert(word);
+            }
+            
+            std::vector<Document> expected_documents;
+            for (const Document& document : search_server.FindTopDocuments(options, query)) {
+                const auto& [matched_words, status] = search_server.MatchDocument(query, document.id);
+                
+                if (std::all_of(plus_words.begin(), plus_words.end(), [&](const std::string& word) {
+                    return word[0] == '-' || std::count(matched_words.begin(), matched_words.end(), word) > 0;
+                })) {
+                    expected_documents.push_back(document);
+                }
+            }
+            
+            AssertSameDocuments(search_server.FindTopDocuments(conjunctive_options, query), expected_documents);
+        }
+        
+        search_server.RemoveDocument(3);
+        search_server.CompressPostings();
+    }
+}
+
+void TestDocumentColumns() {
+    DocumentColumns columns;
+    columns.Append(10, 4, DocumentStatus::ACTUAL);
+    columns.Append(20, -1, DocumentStatus::BANNED);
+    columns.Append(30, 7, DocumentStatus::REMOVED);
+    
+    ASSERT_EQUAL(columns.size(), 3u);
+    ASSERT_EQUAL(columns.GetId(1), 20);
+    ASSERT_EQUAL(columns.GetRating(1), -1);
+    ASSERT(columns.GetStatus(2) == DocumentStatus::REMOVED);
+    
+    const int document_indexes[] = {2, 0, 1};
+    bool accepted[3];
+    auto predicate = [](int document_id, DocumentStatus status, int rating) {
+        return document_id > 10 && status != DocumentStatus::BANNED && rating > 0;
+    };
+    columns.Filter(document_indexes, 3, predicate, accepted);
+    
+    ASSERT(accepted[0]);
+    ASSERT(!accepted[1]);
+    ASSERT(!accepted[2]);
+    
+    // results span many predicate batches in every evaluation mode
+    SearchServer search_server = CreateRandomSearchServer(5000, 40);
+    search_server.RemoveDocument(3);
+    
+    const auto odd_rated = [](int document_id, DocumentStatus status, int rating) {
+        return status == DocumentStatus::ACTUAL && rating % 2 != 0 && document_id % 2 == 0;
+    };
+    
+    SearchOptions options;
+    options.max_result_document_count = 10'000;
+    
+    for (const std::string& query : {"w0"s, "w1 w2 -w3"s, "w0 w1"s}) {
+        std::vector<Document> expected_documents;
+        for (const Document& document : search_server.FindTopDocuments(options, query, DocumentStatus::ACTUAL)) {
+            if (document.rating % 2 != 0 && document.id % 2 == 0) {
+                expected_documents.push_back(document);
+            }
+        }
+        ASSERT(expected_documents.size() > 64u);
+        
+        for (const Evaluation evaluation : {Evaluation::exhaustive, Evaluation::block_max_wand, Evaluation::max_score}) {
+            options.evaluation = evaluation;
+            
+            AssertSameDocuments(search_server.FindTopDocuments(options, query, odd_rated), expected_documents);
+        }
+        
+        options.evaluation = Evaluation::exhaustive;
+    }
+    
+    options.matching = Matching::all;
+    for (const Document& document : search_server.FindTopDocuments(options, "w0 w1"s, odd_rated)) {
+        ASSERT(document.rating % 2 != 0 && document.id % 2 == 0);
+    }
+    
+    ASSERT(search_server.GetMemoryReport().document_column_bytes >= 5000u * (2 * sizeof(int) + 1));
+}
+
+void TestStatusDocuments() {
+    SearchServer search_server = CreateRandomSearchServer(5000, 40);
+    search_server.RemoveDocument(3);
+    
+    SearchOptions options;
+    options.max_result_document_count = 10'000;
+    
+    const auto assert_same_as_predicate = [&search_server, &options](const std::string& query, DocumentStatus status) {
+        for (const Matching matching : {Matching::any, Matching::all}) {
+            options.matching = matching;
+            
+            for (const Evaluation evaluation : {Evaluation::exhaustive, Evaluation::block_max_wand, Evaluation::max_score}) {
+                options.evaluation = evaluation;
+                
+                AssertSameDocuments(search_server.FindTopDocuments(options, query, status),
+                                    search_server.FindTopDocuments(options, query, [status](int, DocumentStatus document_status, int) {
+                                        return document_status == status;
+                                    }));
+            }
+        }
+        
+        options.matching = Matching::any;
+        options.evaluation = Evaluation::exhaustive;
+    };
+    
+    for (const std::string& query : {"w0"s, "w1 w2 -w3"s, "w0 w1"s}) {
+        assert_same_as_predicate(query, DocumentStatus::ACTUAL);
+        assert_same_as_predicate(query, DocumentStatus::BANNED);
+    }
+    
+    // documents of other statuses are not even scored
+    for (const Evaluation evaluation : {Evaluation::exhaustive, Evaluation::block_max_wand, Evaluation::max_score}) {
+        options.evaluation = evaluation;
+        
+        EvaluationStatistics status_statistics;
+        EvaluationStatistics predicate_statistics;
+        options.statistics = &status_statistics;
+        search_server.FindTopDocuments(options, "w0 w1"s, DocumentStatus::BANNED);
+        options.statistics = &predicate_statistics;
+        search_server.FindTopDocuments(options, "w0 w1"s, [](int, DocumentStatus document_status, int) {
+            return document_status == DocumentStatus::BANNED;
+        });
+        options.statistics = nullptr;
+        
+        ASSERT(status_statistics.documents_scored < predicate_statistics.documents_scored);
+        // the exhaustive evaluation counts every posting it walks, skipped or not
+        if (evaluation != Evaluation::exhaustive) {
+            ASSERT(status_statistics.postings_scored < predicate_statistics.postings_scored);
+        }
+    }
+    options.evaluation = Evaluation::exhaustive;
+    
+    search_server.SetDocumentStatus(0, DocumentStatus::IRRELEVANT);
+    search_server.SetDocumentStatus(6, DocumentStatus::IRRELEVANT);
+    search_server.SetDocumentStatus(6, DocumentStatus::BANNED);
+    search_server.SetDocumentStatus(3, DocumentStatus::IRRELEVANT);
+    
+    ASSERT_EQUAL(std::get<1>(search_server.MatchDocument("w0"s, 0)), DocumentStatus::IRRELEVANT);
+    ASSERT_EQUAL(std::get<1>(search_server.MatchDocument("w0"s, 6)), DocumentStatus::BANNED);
+    
+    const SearchServer copy = search_server;
+    for (const std::string& query : {"w0"s, "w1 w2 -w3"s}) {
+        assert_same_as_predicate(query, DocumentStatus::IRRELEVANT);
+        assert_same_as_predicate(query, DocumentStatus::BANNED);
+        
+        AssertSameDocuments(copy.FindTopDocuments(options, query, DocumentStatus::IRRELEVANT),
+                            search_server.FindTopDocuments(options, query, DocumentStatus::IRRELEVANT));
+    }
+    
+    search_server.AddDocument(1'000'000, "w0 unique"s, DocumentStatus::ACTUAL, {1});
+    ASSERT_EQUAL(search_server.FindTopDocuments("unique"s).size(), 1u);
+    
+    search_server.SetDocumentStatus(1'000'000, DocumentStatus::REMOVED);
+    ASSERT(search_server.FindTopDocuments("unique"s).empty());
+    ASSERT_EQUAL(search_server.FindTopDocuments("unique"s, DocumentStatus::REMOVED).size(), 1u);
+}
+
+void TestMaxResultDocumentCount() {
+    SearchServer search_server = CreateRandomSearchServer(2000, 30);
+    
+    SearchOptions options;
+    options.max_result_document_count = 500;
+    
+    const auto many_documents = search_server.FindTopDocuments(options, "w0 w3 -w7"s);
+    const auto default_documents = search_server.FindTopDocuments("w0 w3 -w7"s);
+    
+    ASSERT_EQUAL(many_documents.size(), 500u);
+    ASSERT(std::is_sorted(many_documents.begin(), many_documents.end(), TopDocuments::IsMoreRelevant));
+    AssertSameDocuments(std::vector<Document>(many_documents.begin(), many_documents.begin() + 5), default_documents);
+    
+    for (const Evaluation evaluation : {Evaluation::block_max_wand, Evaluation::max_score}) {
+        options.evaluation = evaluation;
+        
+        AssertSameDocuments(search_server.FindTopDocuments(options, "w0 w3 -w7"s), many_documents);
+    }
+    
+    options.max_result_document_count = 0;
+    ASSERT(search_server.FindTopDocuments(options, "w0 w3 -w7"s).empty());
+    
+    options.max_result_document_count = -1;
+    try {
+        search_server.FindTopDocuments(options, "w0"s);
+    } catch (const std::invalid_argument&) {
+        return;
+    }
+    
+    ASSERT_HINT(false, "negative result document count is not handled"s);
+}
+
+void TestEvaluationStatistics() {
+    SearchServer search_server = CreateRandomSearchServer(5000, 60);
+    
+    EvaluationStatistics exhaustive_statistics;
+    EvaluationStatistics max_score_statistics;
+    
+    SearchOptions options;
+    
+    options.statistics = &exhaustive_statistics;
+    search_server.FindTopDocuments(options, "w0 w1 w50"s);
+    
+    options.evaluation = Evaluation::max_score;
+    options.statistics = &max_score_statistics;
+    search_server.FindTopDocuments(options, "w0 w1 w50"s);
+    
+    ASSERT(exhaustive_statistics.postings_total > 0);
+    ASSERT_EQUAL(exhaustive_statistics.GetPostingsSkipped(), 0u);
+    ASSERT_EQUAL(max_score_statistics.postings_total, exhaustive_statistics.postings_total);
+    ASSERT(max_score_statistics.GetPostingsSkipped() > 0);
+}
+
+void TestShardedSearchServer() {
+    const SearchServer search_server = CreateRandomSearchServer(3000, 50);
+    
+    ShardedSearchServer sharded_search_server(4);
+    AddRandomDocuments(sharded_search_server, 3000, 50);
+    
+    ASSERT_EQUAL(sharded_search_server.GetDocumentCount(), search_server.GetDocumentCount());
+    
+    const std::vector<std::string> queries = {"w0"s, "w1 w2 w3 -w0"s, "w10 w20 w49"s, "nothing"s};
+    
+    for (const Evaluation evaluation : {Evaluation::exhaustive, Evaluation::block_max_wand, Evaluation::max_score}) {
+        SearchOptions options;
+        options.evaluation = evaluation;
+        options.max_result_document_count = 20;
+        
+        for (const std::string& query : queries) {
+            AssertSameDocuments(sharded_search_server.FindTopDocuments(options, query),
+                                search_server.FindTopDocuments(options, query));
+            AssertSameDocuments(sharded_search_server.FindTopDocuments(options, query, DocumentStatus::BANNED),
+                                search_server.FindTopDocuments(options, query, DocumentStatus::BANNED));
+        }
+    }
+    
+    const auto [words, status] = sharded_search_server.MatchDocument("w0 w1 w2 w3"s, 42);
+    ASSERT_EQUAL(std::get<0>(search_server.MatchDocument("w0 w1 w2 w3"s, 42)), words);
+    
+    sharded_search_server.RemoveDocument(42);
+    ASSERT_EQUAL(sharded_search_server.GetDocumentCount(), search_server.GetDocumentCount() - 1);
+    ASSERT(sharded_search_server.GetWordFrequencies(42).empty());
+}
+
+void TestSegmentedSearchServer() {
+    SearchServer search_server = CreateRandomSearchServer(3000, 50);
+    
+    SegmentOptions segment_options;
+    segment_options.write_buffer_document_count = 100;
+    segment_options.segments_per_tier = 3;
+    segment_options.compress_segments = false;
+    
+    SegmentedSearchServer segmented_search_server(""s, segment_options);
+    AddRandomDocuments(segmented_search_server, 3000, 50);
+    
+    for (int document_id = 0; document_id < 9000; document_id += 21) {
+        search_server.RemoveDocument(document_id);
+        segmented_search_server.RemoveDocument(document_id);
+    }
+    
+    segmented_search_server.WaitForMerges();
+    
+    ASSERT_EQUAL(segmented_search_server.GetDocumentCount(), search_server.GetDocumentCount());
+    
+    // 30 buffers make three tier 2 segments at most
+    ASSERT(segmented_search_server.GetSegmentCount() < 10u);
+    
+    const std::vector<std::string> queries = {"w0"s, "w1 w2 w3 -w0"s, "w10 w20 w49"s, "nothing"s};
+    
+    for (const Evaluation evaluation : {Evaluation::exhaustive, Evaluation::block_max_wand, Evaluation::max_score}) {
+        SearchOptions options;
+        options.evaluation = evaluation;
+        options.max_result_document_count = 20;
+        
+        for (const std::string& query : queries) {
+            AssertSameDocuments(segmented_search_server.FindTopDocuments(options, query),
+                                search_server.FindTopDocuments(options, query));
+            AssertSameDocuments(segmented_search_server.FindTopDocuments(options, query, DocumentStatus::BANNED),
+                                search_server.FindTopDocuments(options, query, DocumentStatus::BANNED));
+        }
+    }
+    
+    // removals from merged segments only mark tombstones, some of them get the segment rewritten
+    for (int document_id = 3; document_id < 9000; document_id += 12) {
+        search_server.RemoveDocument(document_id);
+        segmented_search_server.RemoveDocument(document_id);
+    }
+    
+    // a removed id may come back in a new segment
+    search_server.AddDocument(3, "w0 w1 w2"s, DocumentStatus::ACTUAL, {5});
+    segmented_search_server.AddDocument(3, "w0 w1 w2"s, DocumentStatus::ACTUAL, {5});
+    segmented_search_server.Flush();
+    segmented_search_server.WaitForMerges();
+    
+    ASSERT_EQUAL(segmented_search_server.GetDocumentCount(), search_server.GetDocumentCount());
+    
+    for (const Evaluation evaluation : {Evaluation::exhaustive, Evaluation::block_max_wand, Evaluation::max_score}) {
+        SearchOptions options;
+        options.evaluation = evaluation;
+        options.max_result_document_count = 20;
+        
+        for (const std::string& query : queries) {
+            AssertSameDocuments(segmented_search_server.FindTopDocuments(options, query),
+                                search_server.FindTopDocuments(options, query));
+            AssertSameDocuments(segmented_search_server.FindTopDocuments(options, query, DocumentStatus::BANNED),
+                                search_server.FindTopDocuments(options, query, DocumentStatus::BANNED));
+        }
+    }
+    
+    ASSERT(segmented_search_server.GetWordFrequencies(15).empty());
+    ASSERT_EQUAL(std::get<0>(segmented_search_server.MatchDocument("w0 w1 w2 w3"s, 3)),
+                 std::get<0>(search_server.MatchDocument("w0 w1 w2 w3"s, 3)));
+    ASSERT_EQUAL(std::get<0>(segmented_search_server.MatchDocument("w0 w1 w2 w3"s, 45)),
+                 std::get<0>(search_server.MatchDocument("w0 w1 w2 w3"s, 45)));
+    
+    // marked documents count as removed in queries and statistics, the server itself is unchanged
+    {
+        SearchServer shared_search_server = CreateRandomSearchServer(1000, 30);
+        SearchServer removed_search_server = shared_search_server;
+        
+        DocumentBitmap removed_documents;
+        for (int document_id = 0; document_id < 3000; document_id += 9) {
+            shared_search_server.MarkRemoved(document_id, removed_documents);
+            removed_search_server.RemoveDocument(document_id);
+        }
+        
+        const CollectionStatistics collection_statistics = shared_search_server.GetCollectionStatistics("w0 w1 w5"s, &removed_documents);
+        ASSERT_EQUAL(collection_statistics.document_count, removed_search_server.GetDocumentCount());
+        ASSERT_EQUAL(collection_statistics.document_frequencies.at("w1"s), removed_search_server.GetDocumentFrequency("w1"s));
+        
+        SearchOptions options;
+        options.max_result_document_count = 50;
+        options.collection_statistics = &collection_statistics;
+        
+        // the bitmap is in the numbering of the shared server, compaction renumbered the other one
+        SearchOptions shared_options = options;
+        shared_options.removed_documents = &removed_documents;
+        
+        for (const Evaluation evaluation : {Evaluation::exhaustive, Evaluation::block_max_wand, Evaluation::max_score}) {
+            options.evaluation = evaluation;
+            shared_options.evaluation = evaluation;
+            
+            AssertSameDocuments(shared_search_server.FindTopDocuments(shared_options, "w0 w1 w5"s),
+                                removed_search_server.FindTopDocuments(options, "w0 w1 w5"s));
+        }
+        
+        ASSERT_EQUAL(shared_search_server.GetDocumentCount(), 1000);
+    }
+    ASSERT(segmented_search_server.GetWordFrequencies(42).empty());
+    ASSERT_EQUAL(segmented_search_server.GetWordFrequencies(45).size(), search_server.GetWordFrequencies(45).size());
+    
+    // merging keeps exact term frequencies
+    SearchServer merged_search_server;
+    merged_search_server.MergeFrom(search_server);
+    
+    AssertSameDocuments(merged_search_server.FindTopDocuments("w1 w2 w3 -w0"s), search_server.FindTopDocuments("w1 w2 w3 -w0"s));
+    
+    try {
+        merged_search_server.MergeFrom(search_server);
+        ASSERT_HINT(false, "repeating ids must throw"s);
+    } catch (const std::invalid_argument&) {
+    }
+    
+    // a document removed and added again leaves its old slot behind, only the live one is merged
+    SegmentOptions readd_options;
+    readd_options.write_buffer_document_count = 10;
+    readd_options.segments_per_tier = 2;
+    
+    SegmentedSearchServer readd_search_server(""s, readd_options);
+    
+    for (int document_id = 0; document_id < 9; ++document_id) {
+        readd_search_server.AddDocument(document_id, "dog"s, DocumentStatus::ACTUAL, {1});
+    }
+    
+    readd_search_server.RemoveDocument(5);
+    readd_search_server.AddDocument(5, "cat"s, DocumentStatus::ACTUAL, {1});
+    
+    for (int document_id = 9; document_id < 20; ++document_id) {
+        readd_search_server.AddDocument(document_id, "dog"s, DocumentStatus::ACTUAL, {1});
+    }
+    
+    readd_search_server.WaitForMerges();
+    ASSERT_EQUAL(readd_search_server.GetSegmentCount(), 1u);
+    ASSERT_EQUAL(readd_search_server.GetWordFrequencies(5).size(), 1u);
+    
+    readd_search_server.RemoveDocument(5);
+    ASSERT(readd_search_server.FindTopDocuments("cat"s).empty());
+}
+
+void TestConcurrentSearchServer() {
+    ConcurrentSearchServer search_server;
+    
+    search_server.AddDocument(0, "funny cat"s, DocumentStatus::ACTUAL, {1});
+    
+    const std::shared_ptr<const SearchServer> snapshot = search_server.GetSnapshot();
+    
+    std::atomic<bool> is_writing = true;
+    std::atomic<int> reads = 0;
+    
+    std::thread reader([&search_server, &is_writing, &reads] {
+        while (is_writing) {
+            const auto documents = search_server.FindTopDocuments("funny cat"s);
+            
+            ASSERT(!documents.empty());
+            ++reads;
+        }
+    });
+    
+    for (int document_id = 1; document_id <= 100; document_id += 10) {
+        search_server.Update([document_id](SearchServer& server) {
+            for (int i = document_id; i < document_id + 10; ++i) {
+                server.AddDocument(i, "funny dog number "s + std::to_string(i), DocumentStatus::ACTUAL, {i});
+            }
+        });
+    }
+    
+    search_server.RemoveDocument(0);
+    
+    is_writing = false;
+    reader.join();
+    
+    // a failed update publishes nothing
+    try {
+        search_server.Update([](SearchServer& server) {
+            server.AddDocument(1000, "lost document"s, DocumentStatus::ACTUAL, {1});
+            server.AddDocument(1, "repeating id"s, DocumentStatus::ACTUAL, {1});
+        });
+    } catch (const std::invalid_argument&) {
+    }
+    
+    ASSERT_EQUAL(snapshot->GetDocumentCount(), 1);
+    ASSERT_EQUAL(search_server.GetDocumentCount(), 100);
+    ASSERT(search_server.FindTopDocuments("cat"s).empty());
+    ASSERT(search_server.FindTopDocuments("lost"s).empty());
+    ASSERT_EQUAL(snapshot->FindTopDocuments("cat"s).size(), 1u);
+    
+    // single-document writes alternate between two servers, repeating what the other one missed
+    ConcurrentSearchServer alternating_search_server;
+    SearchServer expected_search_server;
+    std::shared_ptr<const SearchServer> held_snapshot;
+    
+    for (int document_id = 0; document_id < 60; ++document_id) {
+        const std::string document = "word"s + std::to_string(document_id % 7) + " common"s;
+        
+        alternating_search_server.AddDocument(document_id, document, DocumentStatus::ACTUAL, {document_id});
+        expected_search_server.AddDocument(document_id, document, DocumentStatus::ACTUAL, {document_id});
+        
+        if (document_id % 3 == 0) {
+            alternating_search_server.RemoveDocument(document_id / 2);
+            expected_search_server.RemoveDocument(document_id / 2);
+        }
+        
+        // a reader holding the standby server makes the next write copy the current one
+        if (document_id % 10 == 0) {
+            held_snapshot = alternating_search_server.GetSnapshot();
+        } else if (document_id % 10 == 2) {
+            held_snapshot.reset();
+        }
+    }
+    
+    try {
+        alternating_search_server.AddDocument(59, "repeating id"s, DocumentStatus::ACTUAL, {1});
+        ASSERT_HINT(false, "repeating ids must throw"s);
+    } catch (const std::invalid_argument&) {
+    }
+    
+    alternating_search_server.AddDocument(60, "word1 late"s, DocumentStatus::ACTUAL, {60});
+    expected_search_server.AddDocument(60, "word1 late"s, DocumentStatus::ACTUAL, {60});
+    alternating_search_server.AddDocument(61, "word2 late"s, DocumentStatus::ACTUAL, {61});
+    expected_search_server.AddDocument(61, "word2 late"s, DocumentStatus::ACTUAL, {61});
+    
+    ASSERT_EQUAL(alternating_search_server.GetDocumentCount(), expected_search_server.GetDocumentCount());
+    
+    SearchOptions options;
+    options.max_result_document_count = 100;
+    
+    for (const std::string& query : {"common"s, "word1 -late"s, "word2 late"s, "repeating"s}) {
+        AssertSameDocuments(alternating_search_server.FindTopDocuments(options, query),
+                            expected_search_server.FindTopDocuments(options, query));
+    }
+}
+
+void TestMemoryReport() {
+    SearchServer search_server;
+    
+    search_server.AddDocument(0, "funny cat"s, DocumentStatus::ACTUAL, {1});
+    search_server.AddDocument(1, "funny dog"s, DocumentStatus::ACTUAL, {1});
+    
+    const MemoryReport report = search_server.GetMemoryReport();
+    
+    ASSERT_EQUAL(report.term_count, 3u);
+    ASSERT_EQUAL(report.posting_count, 4u);
+    ASSERT_EQUAL(report.term_id_bytes, 7 * sizeof(TermId));
+    ASSERT(report.string_key_bytes >= 7 * sizeof(std::string));
+}
+
+void TestStopWordFilter() {
+    StopWordFilter filter;
+    ASSERT(!filter.Contains("in"s));
+    
+    // enough words to rehash a few times
+    for (int i = 0; i < 100; ++i) {
+        filter.Insert("stop"s + std::to_string(i));
+    }
+    filter.Insert("in"s);
+    filter.Insert("in"s);
+    filter.Insert(""s);
+    
+    ASSERT_EQUAL(filter.size(), 101u);
+    ASSERT(filter.Contains("in"s));
+    ASSERT(filter.Contains("stop99"s));
+    ASSERT(!filter.Contains("stop100"s));
+    ASSERT(!filter.Contains("i"s));
+    ASSERT(!filter.Contains(""s));
+    
+    constexpr StaticStopWordFilter<3> static_filter({std::string_view("and"), std::string_view("in"), std::string_view("with")});
+    static_assert(static_filter.Contains(std::string_view("with")));
+    static_assert(!static_filter.Contains(std::string_view("within")));
+    
+    ASSERT(static_filter.Contains("in"s));
+    ASSERT(!static_filter.Contains("on"s));
+}
+
 void TestStopWordsExclusion() {
     const std::vector<int> ratings = {1, 2, 3};
     
@@ -368,6 +1644,55 @@ void TestRelevanceCalculation() {
     }
 }
 
+void TestSplitIntoValidWords() {
+    std::mt19937 generator(11);
+    
+    // long enough for several SIMD blocks, words and space runs cross block borders
+    const std::string alphabet = "ab  \xD0\xBF\x7F~"s;
+    
+    for (int round = 0; round < 500; ++round) {
+        std::string text(std::uniform_int_distribution<size_t>(0, 200)(generator), ' ');
+        for (char& c : text) {
+            c = alphabet[std::uniform_int_distribution<size_t>(0, alphabet.size() - 1)(generator)];
+        }
+        
+        const bool has_control_byte = round % 3 == 0 && !text.empty();
+        if (has_control_byte) {
+            text[std::uniform_int_distribution<size_t>(0, text.size() - 1)(generator)] = round % 2 == 0 ? '\t' : '\x01';
+        }
+        
+        std::vector<std::string_view> expected_words;
+        for (size_t begin = 0; begin < text.size(); ) {
+            const size_t end = std::min(text.find(' ', begin), text.size());
+            if (end > begin) {
+                expected_words.push_back(std::string_view(text).substr(begin, end - begin));
+            }
+            begin = end + 1;
+        }
+        
+        std::vector<std::string_view> words;
+        ASSERT_EQUAL(string_processing::SplitIntoValidWords(text, words), !has_control_byte);
+        
+        std::pmr::monotonic_buffer_resource resource;
+        std::pmr::vector<std::string_view> pmr_words(&resource);
+        ASSERT_EQUAL(string_processing::SplitIntoValidWords(text, pmr_words), !has_control_byte);
+        
+        if (!has_control_byte) {
+            ASSERT_EQUAL(words, expected_words);
+            ASSERT(std::equal(pmr_words.begin(), pmr_words.end(), expected_words.begin(), expected_words.end()));
+            ASSERT_EQUAL(string_processing::SplitIntoWords(std::string_view(text)), expected_words);
+        }
+    }
+    
+    // words are views into the text
+    const std::string_view text = " funny pet  nasty ";
+    std::vector<std::string_view> words;
+    
+    ASSERT(string_processing::SplitIntoValidWords(text, words));
+    ASSERT_EQUAL(words.size(), 3u);
+    ASSERT(words[1].data() == text.data() + 7);
+}
+
 void TestSplitIntoWordsEscapesSpaces() {
     ASSERT_EQUAL((std::vector<std::string> {"hello"s, "bro"s}), string_processing::SplitIntoWords("   hello    bro    "s));
     ASSERT_EQUAL(std::vector<std::string>{}, string_processing::SplitIntoWords("                 "s));
@@ -456,6 +1781,7 @@ void TestSearchNonExistentWord() {
 
 void TestSearchServer() {
     RUN_TEST(TestStopWordsExclusion);
+    RUN_TEST(TestStopWordFilter);
     RUN_TEST(TestAddedDocumentsCanBeFound);
     RUN_TEST(TestMinusWordsExcludeDocuments);
     RUN_TEST(TestMatchDocumentResults);
@@ -466,6 +1792,7 @@ void TestSearchServer() {
     RUN_TEST(TestRelevanceCalculation);
     RUN_TEST(TestSearchNonExistentWord);
     RUN_TEST(TestSplitIntoWordsEscapesSpaces);
+    RUN_TEST(TestSplitIntoValidWords);
     RUN_TEST(TestAddDocumentWithRepeatingId);
     RUN_TEST(TestAddDocumentWithNegativeId);
     RUN_TEST(TestAddDocumentWithSpecialSymbol);
@@ -476,5 +1803,30 @@ void TestSearchServer() {
     RUN_TEST(TestGetWordFrequencies);
     RUN_TEST(TestDeletingDocument);
     RUN_TEST(TestRemoveDuplicates);
+    RUN_TEST(TestArbitraryDocumentIds);
+    RUN_TEST(TestTermDictionary);
+    RUN_TEST(TestPostingList);
+    RUN_TEST(TestCompressedPostingList);
+    RUN_TEST(TestCompressedPostingsSearch);
+    RUN_TEST(TestQuantizationReport);
+    RUN_TEST(TestDynamicPruningMatchesExhaustive);
+    RUN_TEST(TestEvaluationStatistics);
+    RUN_TEST(TestAddDocuments);
+    RUN_TEST(TestInverseDocumentFrequencyCache);
+    RUN_TEST(TestTombstoneRemoval);
+    RUN_TEST(TestForwardIndex);
+    RUN_TEST(TestQueryArena);
+    RUN_TEST(TestLongQueryParsing);
+    RUN_TEST(TestExclusionBitmaps);
+    RUN_TEST(TestExclusionCache);
+    RUN_TEST(TestIntersectionKernels);
+    RUN_TEST(TestConjunctiveMatching);
+    RUN_TEST(TestDocumentColumns);
+    RUN_TEST(TestStatusDocuments);
+    RUN_TEST(TestMaxResultDocumentCount);
+    RUN_TEST(TestShardedSearchServer);
+    RUN_TEST(TestSegmentedSearchServer);
+    RUN_TEST(TestConcurrentSearchServer);
+    RUN_TEST(TestMemoryReport);
 }
 
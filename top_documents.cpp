@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "top_documents.h"
+
+TopDocuments::TopDocuments(size_t capacity) : capacity_(capacity) {
+    heap_.reserve(std::min(capacity, kMaxReservedCapacity));
+}
+
+bool TopDocuments::IsMoreRelevant(const Document& left, const Document& right) {
+    if (std::abs(left.relevance - right.relevance) < kAccuracy) {
+        if (left.rating == right.rating) {
+            return left.id < right.id;
+        }
+
+        return left.rating > right.rating;
+    }
+
+    return left.relevance > right.relevance;
+} // IsMoreRelevant
+
+void TopDocuments::Push(const Document& document) {
+    if (capacity_ == 0) {
+        return;
+    }
+
+    if (heap_.size() < capacity_) {
+        heap_.push_back(document);
+        std::push_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+
+        return;
+    }
+
+    if (IsMoreRelevant(document, heap_.front())) {
+        std::pop_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+        heap_.back() = document;
+        std::push_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+    }
+} // Push
+
+bool TopDocuments::IsFull() const {
+    return heap_.size() >= capacity_;
+}
+
+double TopDocuments::GetThreshold() const {
+    if (!IsFull()) {
+        return -std::numeric_limits<double>::infinity();
+    }
+
+    if (heap_.empty()) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    return heap_.front().relevance - kAccuracy;
+} // GetThreshold
+
+std::vector<Document> TopDocuments::Extract() {
+    std::sort_heap(heap_.begin(), heap_.end(), IsMoreRelevant);
+
+    return std::move(heap_);
+}
+
+std::vector<Document> TopDocuments::Merge(const std::vector<std::vector<Document>>& sorted_lists, size_t capacity) {
+    // list index and position, the most relevant head on top
+    std::vector<std::pair<size_t, size_t>> heads;
+
+    const auto is_less_relevant_head = [&sorted_lists](const std::pair<size_t, size_t>& left, const std::pair<size_t, size_t>& right) {
+        return IsMoreRelevant(sorted_lists[right.first][right.second], sorted_lists[left.first][left.second]);
+    };
+
+    for (size_t list_index = 0; list_index < sorted_lists.size(); ++list_index) {
+        if (!sorted_lists[list_index].empty()) {
+            heads.emplace_back(list_index, 0);
+        }
+    }
+
+    std::make_heap(heads.begin(), heads.end(), is_less_relevant_head);
+
+    std::vector<Document> merged_documents;
+
+    while (merged_documents.size() < capacity && !heads.empty()) {
+        std::pop_heap(heads.begin(), heads.end(), is_less_relevant_head);
+
+        auto& [list_index, position] = heads.back();
+        merged_documents.push_back(sorted_lists[list_index][position]);
+
+        if (++position < sorted_lists[list_index].size()) {
+            std::push_heap(heads.begin(), heads.end(), is_less_relevant_head);
+        } else {
+            heads.pop_back();
+        }
+    }
+
+    return merged_documents;
+} // Merge
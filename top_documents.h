@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "document.h"
+
+// Keeps the best documents seen so far in a bounded heap whose top is the worst kept one.
+class TopDocuments {
+public:
+    static constexpr double kAccuracy = 1e-6;
+
+public:
+    explicit TopDocuments(size_t capacity);
+
+public:
+    // relevance within kAccuracy is a tie broken by higher rating, then by lower id
+    static bool IsMoreRelevant(const Document& left, const Document& right);
+
+    void Push(const Document& document);
+
+    bool IsFull() const;
+
+    // lowest relevance a new document must reach to have a chance to get in
+    double GetThreshold() const;
+
+    // best first
+    std::vector<Document> Extract();
+
+    // k-way merge of lists sorted best first
+    static std::vector<Document> Merge(const std::vector<std::vector<Document>>& sorted_lists, size_t capacity);
+
+private:
+    // large k is usually far more than a query matches
+    static constexpr size_t kMaxReservedCapacity = 1024;
+
+private:
+    size_t capacity_;
+    std::vector<Document> heap_;
+};